@@ -1,4 +1,5 @@
 #include "HabitsView.h"
+#include "asyncdatabasemanager.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -6,7 +7,6 @@
 #include <QFont>
 #include <QProgressBar>
 #include <QDate>
-#include <QCalendarWidget>
 #include <QPushButton>
 #include <QScrollArea>
 #include <QGraphicsDropShadowEffect>
@@ -20,6 +20,7 @@
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QLineEdit>
+#include <QLocale>
 // #include "HabitsView.h"
 // #include <QVBoxLayout>
 // #include <QHBoxLayout>
@@ -46,15 +47,16 @@
 // #include <chrono>
 
 HabitsView::HabitsView(int userId, QWidget *parent)
-    : QWidget(parent), m_nextHabitId(1), m_selectedDate(QDate::currentDate()), m_userId(userId)
+    : QWidget(parent), m_nextHabitId(1), m_selectedDate(QDate::currentDate()), m_userId(userId),
+      m_loadedFromYear(QDate::currentDate().addMonths(-1).year()), m_requestedFromYear(m_loadedFromYear)
 {
     initUI();
-    loadHabitsFromDatabase();
     connectSignals();
     updateStreakDisplay();
     updateDailyHabitsDisplay();
     updateCalendarDisplay();
     updateStatistics();
+    loadHabitsFromDatabase(); // Asynchrone : l'affichage est rafraîchi à réception
 }
 
 void HabitsView::initUI()
@@ -105,36 +107,47 @@ void HabitsView::initUI()
     calendarTitle->setFont(streakFont);
     calendarLayout->addWidget(calendarTitle);
 
-    m_calendar = new QCalendarWidget(calendarFrame);
-    m_calendar->setMinimumWidth(300);
-    m_calendar->setGridVisible(true);
-    m_calendar->setVerticalHeaderFormat(QCalendarWidget::NoVerticalHeader);
-    m_calendar->setSelectionMode(QCalendarWidget::SingleSelection);
-
-    // Style the calendar
-    m_calendar->setStyleSheet(
-        "QCalendarWidget QToolButton {"
-        "  color: #333333;"
-        "  background-color: #f0f0f0;"
-        "  border-radius: 4px;"
-        "  padding: 5px;"
-        "}"
-        "QCalendarWidget QMenu {"
-        "  background-color: white;"
-        "  border: 1px solid #d0d0d0;"
-        "}"
-        "QCalendarWidget QSpinBox {"
-        "  background-color: white;"
-        "  border: 1px solid #d0d0d0;"
-        "  border-radius: 2px;"
-        "}"
-        "QCalendarWidget QTableView {"
-        "  selection-background-color: #4CAF50;"
-        "  selection-color: white;"
-        "}"
-        );
+    // Navigation : mois (ou année) précédent / suivant et choix de la vue
+    QHBoxLayout *heatmapHeader = new QHBoxLayout();
+    QPushButton *previousPageButton = new QPushButton("<", calendarFrame);
+    previousPageButton->setObjectName("heatmapPreviousButton");
+    QPushButton *nextPageButton = new QPushButton(">", calendarFrame);
+    nextPageButton->setObjectName("heatmapNextButton");
+    QPushButton *yearViewButton = new QPushButton("Year", calendarFrame);
+    yearViewButton->setObjectName("heatmapYearButton");
+    yearViewButton->setCheckable(true);
+    for (QPushButton *button : {previousPageButton, nextPageButton, yearViewButton}) {
+        button->setCursor(Qt::PointingHandCursor);
+        button->setStyleSheet(
+            "QPushButton {"
+            "  color: #333333;"
+            "  background-color: #f0f0f0;"
+            "  border: none;"
+            "  border-radius: 4px;"
+            "  padding: 5px 10px;"
+            "}"
+            "QPushButton:checked {"
+            "  background-color: #4CAF50;"
+            "  color: white;"
+            "}"
+            );
+    }
+
+    m_heatmapTitle = new QLabel(calendarFrame);
+    m_heatmapTitle->setAlignment(Qt::AlignCenter);
+    m_heatmapTitle->setStyleSheet("color: #333333; font-weight: bold;");
+
+    heatmapHeader->addWidget(previousPageButton);
+    heatmapHeader->addWidget(m_heatmapTitle, 1);
+    heatmapHeader->addWidget(nextPageButton);
+    heatmapHeader->addWidget(yearViewButton);
+    calendarLayout->addLayout(heatmapHeader);
 
-    calendarLayout->addWidget(m_calendar);
+    m_heatmap = new HabitHeatmap(calendarFrame);
+    m_heatmap->setMinimumWidth(300);
+    updateHeatmapTitle();
+
+    calendarLayout->addWidget(m_heatmap);
     middleLayout->addWidget(calendarFrame);
 
     // Daily habits on the right
@@ -377,6 +390,8 @@ void HabitsView::addNewHabit(const QString &name, int goalDays)
 {
     Habit newHabit(name, goalDays);
     m_habits[m_nextHabitId] = newHabit;
+    m_statistics.addHabit(m_nextHabitId);
+    m_archivedPerfectDays.clear(); // Aucun jour archivé n'est validé pour la nouvelle habitude
     saveHabitToDatabase(m_nextHabitId);
     m_nextHabitId++;
 }
@@ -384,42 +399,12 @@ void HabitsView::addNewHabit(const QString &name, int goalDays)
 void HabitsView::calculateStreaks()
 {
     QDate today = QDate::currentDate();
+    m_statistics.setToday(today);
 
-    for (auto &habit : m_habits) {
-        habit.currentStreak = 0;
-        habit.completedToday = habit.completedDates.contains(today);
-
-        // Calculer le streak le plus long qui inclut aujourd'hui
-        // ou le streak le plus récent si aujourd'hui n'est pas complété
-
-        QDate checkDate = today;
-
-        // Si aujourd'hui n'est pas complété, commencer par hier
-        if (!habit.completedDates.contains(today)) {
-            checkDate = today.addDays(-1);
-        }
-
-        // Compter les jours consécutifs en remontant
-        while (habit.completedDates.contains(checkDate)) {
-            habit.currentStreak++;
-            checkDate = checkDate.addDays(-1);
-        }
-
-        // Alternative : Calculer le streak basé sur la date sélectionnée
-        // si vous voulez montrer le streak pour une date spécifique
-        /*
-        QDate selectedDate = m_selectedDate;
-        if (habit.completedDates.contains(selectedDate)) {
-            habit.currentStreak = 0;
-            QDate checkDate = selectedDate;
-
-            // Compter vers le passé
-            while (habit.completedDates.contains(checkDate)) {
-                habit.currentStreak++;
-                checkDate = checkDate.addDays(-1);
-            }
-        }
-        */
+    // Les séries sont tenues à jour par m_statistics : simple recopie pour l'affichage
+    for (auto it = m_habits.begin(); it != m_habits.end(); ++it) {
+        it->completedToday = it->completedDates.contains(today);
+        it->currentStreak = m_statistics.currentStreak(it.key());
     }
 }
 
@@ -451,6 +436,7 @@ void HabitsView::updateStreakDisplay()
         habitLabel->setFont(habitFont);
 
         QLabel *daysLabel = new QLabel(QString::number(habit.currentStreak) + " days");
+        daysLabel->setToolTip(QString("Best: %1 days").arg(m_statistics.longestStreak(it.key())));
 
         QProgressBar *progressBar = new QProgressBar();
         progressBar->setRange(0, habit.goalDays);
@@ -513,49 +499,18 @@ void HabitsView::updateDailyHabitsDisplay()
 
 void HabitsView::updateCalendarDisplay()
 {
-    // Clear existing calendar formatting
-    m_calendar->setDateTextFormat(QDate(), QTextCharFormat());
-
-    // Mark completed dates
-    for (const auto &habit : m_habits) {
-        for (const QDate &date : habit.completedDates) {
-            if (date.month() == m_calendar->monthShown() &&
-                date.year() == m_calendar->yearShown()) {
-                m_calendar->setDateTextFormat(date, getDateTextFormat(Qt::green));
-            }
-        }
-    }
-
-    // Count habits completed per day and use different colors
-    QMap<QDate, int> completionCounts;
-    for (const auto &habit : m_habits) {
-        for (const QDate &date : habit.completedDates) {
-            completionCounts[date]++;
-        }
-    }
-
-    // Apply different colors based on completion ratio
-    int totalHabits = m_habits.size();
-    if (totalHabits > 0) {
-        for (auto it = completionCounts.begin(); it != completionCounts.end(); ++it) {
-            QDate date = it.key();
-            int completed = it.value();
-            double ratio = (double)completed / totalHabits;
-
-            QColor color;
-            if (ratio >= 0.9) {
-                color = Qt::darkGreen;  // Almost all habits completed
-            } else if (ratio >= 0.7) {
-                color = Qt::green;      // Most habits completed
-            } else if (ratio >= 0.5) {
-                color = QColor(255, 165, 0); // Orange - half completed
-            } else {
-                color = QColor(255, 99, 71);  // Light red - few completed
-            }
+    // Ratios de toute l'année affichée, lus dans m_statistics (un accès par jour,
+    // quel que soit le nombre d'habitudes) ; la carte se redessine en une fois
+    const int year = m_heatmap->yearShown();
+    m_heatmap->setRatios(year, m_statistics.dayRatios(year));
+}
 
-            m_calendar->setDateTextFormat(date, getDateTextFormat(color));
-        }
-    }
+void HabitsView::updateHeatmapTitle()
+{
+    const QDate firstOfPage(m_heatmap->yearShown(), m_heatmap->monthShown(), 1);
+    m_heatmapTitle->setText(m_heatmap->mode() == HabitHeatmap::Mode::Year
+                                ? QString::number(firstOfPage.year())
+                                : QLocale().toString(firstOfPage, "MMMM yyyy"));
 }
 
 void HabitsView::updateStatistics()
@@ -570,69 +525,44 @@ void HabitsView::updateStatistics()
         return;
     }
 
-    // Calculate completion rate (for current week)
-    QDate today = QDate::currentDate();
-    QDate weekStart = today.addDays(-6);
-    int totalPossible = totalHabits * 7;
-    int totalCompleted = 0;
-
-    for (int i = 0; i < 7; i++) {
-        QDate checkDate = weekStart.addDays(i);
-        for (const auto &habit : m_habits) {
-            if (habit.completedDates.contains(checkDate)) {
-                totalCompleted++;
-            }
-        }
-    }
+    // Valeurs maintenues à chaque complétion par m_statistics : lecture seule ici
+    m_statistics.setToday(QDate::currentDate());
 
-    m_completionRate = totalPossible > 0 ? (double)totalCompleted / totalPossible * 100 : 0;
+    // Completion rate (7 derniers jours)
+    m_completionRate = m_statistics.completionRate();
     m_completionRateLabel->setText(QString::number((int)m_completionRate) + "%");
 
-    // Find longest streak
-    m_longestStreak = 0;
-    for (const auto &habit : m_habits) {
-        if (habit.currentStreak > m_longestStreak) {
-            m_longestStreak = habit.currentStreak;
-        }
-    }
+    // Longest streak : record historique, pas seulement la plus longue série en cours
+    m_longestStreak = m_statistics.longestStreakEver();
     m_longestStreakLabel->setText(QString::number(m_longestStreak) + " days");
 
-    // Calculate perfect days (days where all habits were completed)
-    QSet<QDate> allDates;
-    for (const auto &habit : m_habits) {
-        for (const QDate &date : habit.completedDates) {
-            allDates.insert(date);
-        }
-    }
-
-    m_perfectDays = 0;
-    for (const QDate &date : allDates) {
-        int habitsCompletedOnDate = 0;
-        for (const auto &habit : m_habits) {
-            if (habit.completedDates.contains(date)) {
-                habitsCompletedOnDate++;
-            }
-        }
-        if (habitsCompletedOnDate == totalHabits) {
-            m_perfectDays++;
-        }
-    }
+    // Perfect days (days where all habits were completed)
+    m_perfectDays = m_statistics.perfectDays();
     m_perfectDaysLabel->setText(QString::number(m_perfectDays));
 }
 
-QTextCharFormat HabitsView::getDateTextFormat(const QColor &color)
-{
-    QTextCharFormat format;
-    format.setBackground(color);
-    format.setForeground(Qt::white);
-    return format;
-}
 
 void HabitsView::connectSignals()
 {
     // Connect calendar date change
-    connect(m_calendar, &QCalendarWidget::selectionChanged,
+    connect(m_heatmap, &HabitHeatmap::selectionChanged,
             this, &HabitsView::onDateSelected);
+    connect(m_heatmap, &HabitHeatmap::currentPageChanged,
+            this, &HabitsView::onCalendarPageChanged);
+
+    // Heatmap navigation
+    QPushButton *previousPageButton = findChild<QPushButton*>("heatmapPreviousButton");
+    if (previousPageButton) {
+        connect(previousPageButton, &QPushButton::clicked, m_heatmap, &HabitHeatmap::showPreviousPage);
+    }
+    QPushButton *nextPageButton = findChild<QPushButton*>("heatmapNextButton");
+    if (nextPageButton) {
+        connect(nextPageButton, &QPushButton::clicked, m_heatmap, &HabitHeatmap::showNextPage);
+    }
+    QPushButton *yearViewButton = findChild<QPushButton*>("heatmapYearButton");
+    if (yearViewButton) {
+        connect(yearViewButton, &QPushButton::toggled, this, &HabitsView::onHeatmapModeToggled);
+    }
 
     // Connect add habit button
     QPushButton *addButton = findChild<QPushButton*>("addHabitButton");
@@ -643,7 +573,7 @@ void HabitsView::connectSignals()
 
 void HabitsView::onDateSelected()
 {
-    m_selectedDate = m_calendar->selectedDate();
+    m_selectedDate = m_heatmap->selectedDate();
 
     // Update the title
     QLabel *titleLabel = findChild<QLabel*>("habitsTitle");
@@ -658,6 +588,23 @@ void HabitsView::onDateSelected()
     updateDailyHabitsDisplay();
 }
 
+void HabitsView::onCalendarPageChanged(int year, int month)
+{
+    Q_UNUSED(month);
+    updateHeatmapTitle();
+    // La carte ne montre que les jours de la page : seule son année est nécessaire
+    if (year < m_requestedFromYear) {
+        loadHabitYearsFromDatabase(year);
+    }
+    updateCalendarDisplay();
+}
+
+void HabitsView::onHeatmapModeToggled(bool yearView)
+{
+    m_heatmap->setMode(yearView ? HabitHeatmap::Mode::Year : HabitHeatmap::Mode::Month);
+    updateHeatmapTitle();
+}
+
 void HabitsView::onAddHabitClicked()
 {
     QDialog dialog(this);
@@ -714,17 +661,22 @@ void HabitsView::onHabitChecked(bool checked)
     if (!m_habits.contains(habitId)) return;
 
     Habit &habit = m_habits[habitId];
+    if (habit.completedDates.contains(m_selectedDate) == checked) {
+        return; // Déjà dans cet état : ne pas compter deux fois
+    }
 
     if (checked) {
         habit.completedDates.insert(m_selectedDate);
     } else {
         habit.completedDates.remove(m_selectedDate);
     }
+    m_statistics.setCompleted(habitId, m_selectedDate, checked);
 
-    saveHabitToDatabase(habitId);
+    // Seule la date modifiée est écrite, pas tout l'historique de l'habitude
+    saveCompletionToDatabase(habitId, m_selectedDate, checked);
     calculateStreaks();
     updateStreakDisplay();
-    updateCalendarDisplay();
+    m_heatmap->setRatio(m_selectedDate, m_statistics.ratioOn(m_selectedDate)); // Une seule case redessinée
     updateStatistics();
 }
 void HabitsView::saveHabitToDatabase(int habitId)
@@ -732,33 +684,133 @@ void HabitsView::saveHabitToDatabase(int habitId)
     if (!m_habits.contains(habitId)) {
         return;
     }
-    DatabaseManager dbManager;
     const Habit &habit = m_habits[habitId];
-    dbManager.saveHabit(m_userId, habitId, habit.name, habit.goalDays, habit.completedDates);
+    AsyncDatabaseManager::instance().saveHabit(m_userId, habitId, habit.name, habit.goalDays, habit.completedDates);
+}
+void HabitsView::saveCompletionToDatabase(int habitId, const QDate &date, bool completed)
+{
+    AsyncDatabaseManager &dbManager = AsyncDatabaseManager::instance();
+    if (completed) {
+        dbManager.addHabitCompletion(m_userId, habitId, date);
+    } else {
+        dbManager.removeHabitCompletion(m_userId, habitId, date);
+    }
 }
+namespace {
+// Habitudes des années récentes et journées parfaites des années plus anciennes
+struct HabitsLoadResult
+{
+    DbResult<AsyncDatabaseManager::HabitRows> habits;
+    QMap<int, int> archivedPerfectDays;
+};
+}
+
 void HabitsView::loadHabitsFromDatabase()
 {
-    DatabaseManager dbManager;
-    QMap<int, QMap<QString, QVariant>> habits;
-    if (dbManager.loadHabits(m_userId, habits)) {
+    // Vue désactivée (listes vides) jusqu'à l'arrivée des habitudes
+    setEnabled(false);
+
+    const int userId = m_userId;
+    const int fromYear = m_loadedFromYear;
+    AsyncDatabaseManager::instance().run([userId, fromYear](DatabaseManager &dbManager) {
+        HabitsLoadResult result;
+        result.habits.ok = dbManager.loadHabits(userId, result.habits.value, fromYear)
+                           && dbManager.loadArchivedPerfectDays(userId, fromYear, result.archivedPerfectDays);
+        return result;
+    }).then(this, [this](HabitsLoadResult result) {
         m_habits.clear();
-        m_nextHabitId = dbManager.getNextHabitId(m_userId);
-        for (auto it = habits.constBegin(); it != habits.constEnd(); ++it) {
-            int habitId = it.key();
-            const QMap<QString, QVariant> &data = it.value();
-            Habit habit(data["name"].toString(), data["goalDays"].toInt());
-            habit.completedDates = data["completedDates"].value<QSet<QDate>>();
-            m_habits[habitId] = habit;
+        m_archivedPerfectDays.clear();
+        if (result.habits.ok) {
+            // Les Habit arrivent prêts : on reprend la map telle quelle
+            m_habits = std::move(result.habits.value);
+            m_archivedPerfectDays = std::move(result.archivedPerfectDays);
+            // Équivalent de MAX(habit_id) + 1, sans requête supplémentaire
+            m_nextHabitId = m_habits.isEmpty() ? 1 : m_habits.lastKey() + 1;
+        } else {
+            // Initialize default habits if none exist (one transaction for all of them)
+            const QStringList defaultHabits = {"Morning Workout", "Meditation", "Drink Water", "Reading"};
+            for (const QString &name : defaultHabits) {
+                m_habits[m_nextHabitId++] = Habit(name, 30);
+            }
+
+            const int userId = m_userId;
+            const QMap<int, Habit> habitsToSave = m_habits;
+            AsyncDatabaseManager::instance().run([userId, habitsToSave](DatabaseManager &dbManager) {
+                DatabaseManager::Transaction transaction(dbManager);
+                for (auto it = habitsToSave.constBegin(); it != habitsToSave.constEnd(); ++it) {
+                    const Habit &habit = it.value();
+                    dbManager.saveHabit(userId, it.key(), habit.name, habit.goalDays, habit.completedDates);
+                }
+                return transaction.commit();
+            });
         }
-    } else {
-        // Initialize default habits if none exist
-        addNewHabit("Morning Workout", 30);
-        addNewHabit("Meditation", 30);
-        addNewHabit("Drink Water", 30);
-        addNewHabit("Reading", 30);
+
+        // Seul calcul complet des statistiques : ensuite, mises à jour incrémentales
+        resetStatistics();
+
+        calculateStreaks();
+        updateStreakDisplay();
+        updateDailyHabitsDisplay();
+        updateCalendarDisplay();
+        updateStatistics();
+        setEnabled(true);
+    });
+}
+
+void HabitsView::loadHabitYearsFromDatabase(int fromYear)
+{
+    const int toYear = m_requestedFromYear; // Exclu : déjà chargé ou demandé
+    m_requestedFromYear = fromYear;
+    setEnabled(false);
+
+    const int userId = m_userId;
+    AsyncDatabaseManager::instance().run([userId, fromYear, toYear](DatabaseManager &dbManager) {
+        DbResult<QMap<int, CompletionBitmap>> result;
+        result.ok = true;
+        for (int year = fromYear; year < toYear && result.ok; ++year) {
+            QMap<int, CompletionBitmap> completions;
+            result.ok = dbManager.loadHabitYear(userId, year, completions);
+            for (auto it = completions.constBegin(); it != completions.constEnd(); ++it) {
+                result.value[it.key()].unite(it.value());
+            }
+        }
+        return result;
+    }).then(this, [this, fromYear, toYear](const DbResult<QMap<int, CompletionBitmap>> &result) {
+        if (!result.ok) {
+            m_requestedFromYear = toYear; // Nouvel essai à la prochaine navigation
+            setEnabled(true);
+            return;
+        }
+
+        // Les années lues quittent les résumés pour rejoindre les bitmaps détaillés
         for (auto it = m_habits.begin(); it != m_habits.end(); ++it) {
-            saveHabitToDatabase(it.key());
+            for (int year = fromYear; year < toYear; ++year) {
+                it->archivedYears.remove(year);
+            }
+            if (result.value.contains(it.key())) {
+                it->completedDates.unite(result.value.value(it.key()));
+            }
         }
+        for (int year = fromYear; year < toYear; ++year) {
+            m_archivedPerfectDays.remove(year);
+        }
+        m_loadedFromYear = qMin(m_loadedFromYear, fromYear);
+
+        resetStatistics();
+        calculateStreaks();
+        updateStreakDisplay();
+        updateDailyHabitsDisplay();
+        updateCalendarDisplay();
+        updateStatistics();
+        setEnabled(true);
+    });
+}
+
+void HabitsView::resetStatistics()
+{
+    int archivedPerfectDays = 0;
+    for (int days : m_archivedPerfectDays) {
+        archivedPerfectDays += days;
     }
-    calculateStreaks();
+    m_statistics.reset(m_habits, QDate::currentDate(), m_loadedFromYear, archivedPerfectDays);
 }
@@ -4,8 +4,6 @@
 #include <QWidget>
 #include <QVBoxLayout>
 #include <QGridLayout>
-#include <QCalendarWidget>
-#include <QTextCharFormat>
 #include <QFrame>
 #include <QCheckBox>
 #include <QProgressBar>
@@ -14,18 +12,9 @@
 #include <QSet>
 #include <QDate>
 #include "databasemanager.h"
-
-struct Habit
-{
-    QString name;
-    int currentStreak;
-    int goalDays;
-    QSet<QDate> completedDates;
-    bool completedToday;
-
-    Habit() : currentStreak(0), goalDays(30), completedToday(false) {}
-    Habit(const QString &n, int goal = 30) : name(n), currentStreak(0), goalDays(goal), completedToday(false) {}
-};
+#include "habit.h"
+#include "habitstatistics.h"
+#include "habitheatmap.h"
 
 class HabitsView : public QWidget
 {
@@ -38,16 +27,22 @@ private slots:
     void onDateSelected();
     void onAddHabitClicked();
     void onHabitChecked(bool checked);
+    void onCalendarPageChanged(int year, int month);
+    void onHeatmapModeToggled(bool yearView);
 
 private:
     void loadHabitsFromDatabase();
+    void loadHabitYearsFromDatabase(int fromYear);
+    void resetStatistics();
     void saveHabitToDatabase(int habitId);
+    void saveCompletionToDatabase(int habitId, const QDate &date, bool completed);
     void initUI();
     // void loadInitialData();
     void connectSignals();
     void updateStreakDisplay();
     void updateDailyHabitsDisplay();
     void updateCalendarDisplay();
+    void updateHeatmapTitle();
     void updateStatistics();
     void addNewHabit(const QString &name, int goalDays = 30);
     void calculateStreaks();
@@ -56,14 +51,19 @@ private:
     QFrame* createStyledFrame();
     QFrame* createStyledCard(const QString &title, const QString &value, const QString &colorHex);
     QFrame* createHabitCheckItem(const QString &habitName, bool checked, int habitId);
-    QTextCharFormat getDateTextFormat(const QColor &color);
 
     // Data members
     QMap<int, Habit> m_habits;
     int m_nextHabitId;
     QDate m_selectedDate;
      int m_userId;
-    // Statistics
+    // Statistics (maintenues par m_statistics, lues par updateStatistics)
+    HabitStatistics m_statistics;
+    // Chargement paresseux : années >= m_loadedFromYear en mémoire, les plus
+    // anciennes lues à la navigation dans le calendrier
+    int m_loadedFromYear;
+    int m_requestedFromYear;           // Dernière demande envoyée (évite les doublons)
+    QMap<int, int> m_archivedPerfectDays; // Journées parfaites des années non chargées
     double m_completionRate;
     int m_longestStreak;
     int m_perfectDays;
@@ -71,7 +71,8 @@ private:
     // UI components
     QGridLayout *m_streakGrid;
     QVBoxLayout *m_dailyHabitsLayout;
-    QCalendarWidget *m_calendar;
+    HabitHeatmap *m_heatmap;
+    QLabel *m_heatmapTitle;
 
     // Statistics cards (for dynamic updates)
     QLabel *m_completionRateLabel;
@@ -1,19 +1,20 @@
 #include "mealplanview.h"
 #include "databasemanager.h"
+#include "asyncdatabasemanager.h"
 #include <QTimer>
 #include <QPropertyAnimation>
 #include <QGraphicsOpacityEffect>
 
-MealPlanView::MealPlanView(int userId, QWidget *parent) : QWidget(parent), m_userId(userId) {
+MealPlanView::MealPlanView(int userId, QWidget *parent) : QWidget(parent), m_userId(userId), m_loadingLabel(nullptr) {
     selectedDate = QDate::currentDate();
     qDebug() << "Initializing MealPlanView for user:" << userId;
     qDebug() << "Current date:" << selectedDate.toString();
 
-    loadWeeklyMealsFromDatabase();
-    debugMealData(); // Ajoutez cette ligne pour debug
-
     setupUI();
     updateMealsForCurrentDay();
+
+    // Chargement asynchrone : les cartes de repas sont créées à réception
+    loadWeeklyMealsFromDatabase();
 }
 MealPlanView::~MealPlanView() {
     // Nettoyage si nécessaire
@@ -138,15 +139,16 @@ void MealPlanView::setupNutritionOverview() {
     QHBoxLayout *macrosLayout = new QHBoxLayout();
     macrosLayout->setSpacing(15);
 
-    macrosLayout->addWidget(createMacroWidget("Protéines", 32, "125g", "#4cc9f0"), 1);
-    macrosLayout->addWidget(createMacroWidget("Glucides", 43, "250g", "#4361ee"), 1);
-    macrosLayout->addWidget(createMacroWidget("Lipides", 25, "70g", "#3a0ca3"), 1);
+    // Valeurs renseignées par updateNutritionData() à partir des repas du jour
+    macrosLayout->addWidget(createMacroWidget("Protéines", "#4cc9f0"), 1);
+    macrosLayout->addWidget(createMacroWidget("Glucides", "#4361ee"), 1);
+    macrosLayout->addWidget(createMacroWidget("Lipides", "#3a0ca3"), 1);
 
     nutritionLayout->addLayout(macrosLayout);
     mainLayout->addWidget(nutritionWidget);
 }
 
-QWidget* MealPlanView::createMacroWidget(const QString &name, int percentage, const QString &value, const QString &colorHex) {
+QWidget* MealPlanView::createMacroWidget(const QString &name, const QString &colorHex) {
     QWidget *macroWidget = new QWidget();
     QVBoxLayout *macroLayout = new QVBoxLayout(macroWidget);
     macroLayout->setSpacing(5);
@@ -156,7 +158,7 @@ QWidget* MealPlanView::createMacroWidget(const QString &name, int percentage, co
     QLabel *nameLabel = new QLabel(name);
     nameLabel->setStyleSheet("font-size: 14px; color: #2b2d42;");
 
-    QLabel *percentLabel = new QLabel(QString("%1%").arg(percentage));
+    QLabel *percentLabel = new QLabel("0%");
     percentLabel->setStyleSheet("font-size: 14px; font-weight: bold; color: " + colorHex + ";");
     percentLabel->setAlignment(Qt::AlignRight);
 
@@ -167,7 +169,7 @@ QWidget* MealPlanView::createMacroWidget(const QString &name, int percentage, co
     // Barre de progression
     QProgressBar *progressBar = new QProgressBar();
     progressBar->setRange(0, 100);
-    progressBar->setValue(percentage);
+    progressBar->setValue(0);
     progressBar->setTextVisible(false);
     progressBar->setFixedHeight(8);
     progressBar->setStyleSheet("QProgressBar { background-color: #e9ecef; border-radius: 4px; } "
@@ -175,10 +177,12 @@ QWidget* MealPlanView::createMacroWidget(const QString &name, int percentage, co
     macroLayout->addWidget(progressBar);
 
     // Valeur
-    QLabel *valueLabel = new QLabel(value);
+    QLabel *valueLabel = new QLabel("0g");
     valueLabel->setStyleSheet("font-size: 16px; font-weight: bold; color: #2b2d42;");
     macroLayout->addWidget(valueLabel);
 
+    macroDisplays.append(MacroDisplay{percentLabel, progressBar, valueLabel});
+
     return macroWidget;
 }
 
@@ -256,7 +260,7 @@ QWidget* MealPlanView::createMealCard(const MealInfo &meal) {
     QVBoxLayout *caloriesLayout = new QVBoxLayout(caloriesWidget);
     caloriesLayout->setAlignment(Qt::AlignRight | Qt::AlignTop);
 
-    QLabel *caloriesLabel = new QLabel(meal.calories);
+    QLabel *caloriesLabel = new QLabel(QString("%1 kcal").arg(meal.calories));
     caloriesLabel->setStyleSheet("font-size: 18px; font-weight: bold; color: #4cc9f0;");
 
     QPushButton *detailsButton = new QPushButton("Détails");
@@ -346,19 +350,41 @@ QList<MealPlanView::ExerciseInfo> MealPlanView::getExercisesForDay(int dayOfWeek
 }
 
 void MealPlanView::updateNutritionData() {
-    // Calculer les calories totales pour le jour
+    // Calculer les calories et les macronutriments totaux pour le jour
     int totalCalories = 0;
+    int macroGrams[3] = {0, 0, 0}; // Protéines, glucides, lipides
     for (const MealInfo &meal : currentMeals) {
-        QString caloriesStr = meal.calories;
-        caloriesStr.remove(" kcal");
-        totalCalories += caloriesStr.toInt();
+        totalCalories += meal.calories;
+        macroGrams[0] += meal.proteinGrams;
+        macroGrams[1] += meal.carbsGrams;
+        macroGrams[2] += meal.fatGrams;
     }
 
     int targetCalories = 2200;
     caloriesOverviewLabel->setText(QString("%1 / %2 kcal").arg(totalCalories).arg(targetCalories));
 
     caloriesProgressBar->setRange(0, targetCalories);
-    caloriesProgressBar->setValue(totalCalories);
+    caloriesProgressBar->setValue(qMin(totalCalories, targetCalories));
+
+    // Part de chaque macronutriment dans l'apport énergétique (4 / 4 / 9 kcal par gramme)
+    const int kcalPerGram[3] = {4, 4, 9};
+    int macroCalories = 0;
+    for (int i = 0; i < 3; ++i) {
+        macroCalories += macroGrams[i] * kcalPerGram[i];
+    }
+    for (int i = 0; i < qMin(3, int(macroDisplays.size())); ++i) {
+        // Aucun repas du jour avec des macronutriments saisis : rien à afficher
+        if (macroCalories == 0) {
+            macroDisplays[i].percentLabel->setText("n/a");
+            macroDisplays[i].progressBar->setValue(0);
+            macroDisplays[i].valueLabel->setText("n/a");
+            continue;
+        }
+        int percentage = qRound(100.0 * macroGrams[i] * kcalPerGram[i] / macroCalories);
+        macroDisplays[i].percentLabel->setText(QString("%1%").arg(percentage));
+        macroDisplays[i].progressBar->setValue(percentage);
+        macroDisplays[i].valueLabel->setText(QString("%1g").arg(macroGrams[i]));
+    }
 }
 
 // void MealPlanView::updateExerciseData() {
@@ -539,192 +565,236 @@ void MealPlanView::onNextDay() {
 //     }
 // }
 void MealPlanView::saveWeeklyMealsToDatabase() {
-    DatabaseManager dbManager;
-    for (auto it = weeklyMeals.constBegin(); it != weeklyMeals.constEnd(); ++it) {
-        int dayOfWeek = it.key();
-        for (const MealInfo &meal : it.value()) {
-            QString caloriesStr = meal.calories;  // 1. Déclarer ET initialiser la copie
-            caloriesStr.remove(" kcal");          // 2. Modifier la copie
-            int calories = caloriesStr.toInt();   // 3. Utiliser la copie
-
-            dbManager.saveMeal(m_userId, dayOfWeek, meal.name, meal.time, calories, meal.image, meal.ingredients);
+    const int userId = m_userId;
+    const QMap<int, QList<MealInfo>> meals = weeklyMeals;
+    const QMap<int, QList<ExerciseInfo>> exercises = weeklyExercises;
+
+    // Toute la semaine est écrite dans une seule transaction (un seul COMMIT),
+    // sur le thread base de données
+    AsyncDatabaseManager::instance().run([userId, meals, exercises](DatabaseManager &dbManager) {
+        DatabaseManager::Transaction transaction(dbManager);
+        for (auto it = meals.constBegin(); it != meals.constEnd(); ++it) {
+            int dayOfWeek = it.key();
+            for (const MealInfo &meal : it.value()) {
+                dbManager.saveMeal(userId, dayOfWeek, meal);
+            }
         }
-    }
-    for (auto it = weeklyExercises.constBegin(); it != weeklyExercises.constEnd(); ++it) {
-        int dayOfWeek = it.key();
-        for (const ExerciseInfo &exercise : it.value()) {
-            QString caloriesStr = exercise.calories; // 1. Déclarer ET initialiser la copie
-            caloriesStr.remove(" kcal");             // 2. Modifier la copie
-            int calories = caloriesStr.toInt();      // 3. Utiliser la copie
-
-            dbManager.saveExercise(m_userId, dayOfWeek, exercise.name, exercise.duration, calories, exercise.completed);
+        for (auto it = exercises.constBegin(); it != exercises.constEnd(); ++it) {
+            int dayOfWeek = it.key();
+            for (const ExerciseInfo &exercise : it.value()) {
+                dbManager.saveExercise(userId, dayOfWeek, exercise.name, exercise.duration, exercise.calories, exercise.completed);
+            }
         }
-    }
+
+        if (!transaction.commit()) {
+            qDebug() << "Failed to save weekly meal plan to database";
+            return false;
+        }
+        return true;
+    });
 }
 void MealPlanView::initializeDefaultMeals() {
+    // Après les ingrédients : protéines, glucides et lipides en grammes
     // LUNDI
     weeklyMeals[1] = {
-        {"Petit-déjeuner", "07:30", "380 kcal", ":/images/breakfast_mon.png",
-         {{"Muesli", "60g"}, {"Lait écrémé", "200ml"}, {"Fraises", "100g"}, {"Noix", "20g"}}},
-        {"Déjeuner", "12:30", "520 kcal", ":/images/lunch_mon.png",
-         {{"Salade verte", "150g"}, {"Blanc de poulet", "120g"}, {"Quinoa", "80g"}, {"Avocat", "50g"}}},
-        {"Collation", "16:00", "180 kcal", ":/images/snack_mon.png",
-         {{"Yaourt grec", "125g"}, {"Amandes", "15g"}, {"Miel", "10g"}}},
-        {"Dîner", "19:30", "450 kcal", ":/images/dinner_mon.png",
-         {{"Saumon grillé", "100g"}, {"Brocolis", "150g"}, {"Patate douce", "120g"}}}
+        {"Petit-déjeuner", "07:30", 380, ":/images/breakfast_mon.png",
+         {{"Muesli", "60g"}, {"Lait écrémé", "200ml"}, {"Fraises", "100g"}, {"Noix", "20g"}}, 17, 52, 11},
+        {"Déjeuner", "12:30", 520, ":/images/lunch_mon.png",
+         {{"Salade verte", "150g"}, {"Blanc de poulet", "120g"}, {"Quinoa", "80g"}, {"Avocat", "50g"}}, 39, 58, 14},
+        {"Collation", "16:00", 180, ":/images/snack_mon.png",
+         {{"Yaourt grec", "125g"}, {"Amandes", "15g"}, {"Miel", "10g"}}, 7, 22, 7},
+        {"Dîner", "19:30", 450, ":/images/dinner_mon.png",
+         {{"Saumon grillé", "100g"}, {"Brocolis", "150g"}, {"Patate douce", "120g"}}, 39, 39, 15}
     };
 
     // MARDI
     weeklyMeals[2] = {
-        {"Petit-déjeuner", "07:30", "350 kcal", ":/images/breakfast_tue.png",
-         {{"Pain complet", "2 tranches"}, {"Avocat", "1/2"}, {"Œuf", "1"}, {"Tomate", "50g"}}},
-        {"Déjeuner", "12:30", "480 kcal", ":/images/lunch_tue.png",
-         {{"Riz brun", "80g"}, {"Légumes sautés", "200g"}, {"Tofu", "100g"}}},
-        {"Collation", "16:00", "150 kcal", ":/images/snack_tue.png",
-         {{"Pomme", "1 moyenne"}, {"Beurre d'amande", "15g"}}},
-        {"Dîner", "19:30", "420 kcal", ":/images/dinner_tue.png",
-         {{"Escalope de dinde", "120g"}, {"Courgettes", "150g"}, {"Riz basmati", "60g"}}}
+        {"Petit-déjeuner", "07:30", 350, ":/images/breakfast_tue.png",
+         {{"Pain complet", "2 tranches"}, {"Avocat", "1/2"}, {"Œuf", "1"}, {"Tomate", "50g"}}, 16, 48, 10},
+        {"Déjeuner", "12:30", 480, ":/images/lunch_tue.png",
+         {{"Riz brun", "80g"}, {"Légumes sautés", "200g"}, {"Tofu", "100g"}}, 36, 54, 13},
+        {"Collation", "16:00", 150, ":/images/snack_tue.png",
+         {{"Pomme", "1 moyenne"}, {"Beurre d'amande", "15g"}}, 6, 19, 6},
+        {"Dîner", "19:30", 420, ":/images/dinner_tue.png",
+         {{"Escalope de dinde", "120g"}, {"Courgettes", "150g"}, {"Riz basmati", "60g"}}, 37, 37, 14}
     };
 
     // MERCREDI
     weeklyMeals[3] = {
-        {"Petit-déjeuner", "07:30", "400 kcal", ":/images/breakfast_wed.png",
-         {{"Flocons d'avoine", "50g"}, {"Banane", "1"}, {"Lait d'amande", "200ml"}, {"Graines de chia", "10g"}}},
-        {"Déjeuner", "12:30", "550 kcal", ":/images/lunch_wed.png",
-         {{"Salade de lentilles", "150g"}, {"Feta", "50g"}, {"Concombre", "100g"}, {"Huile d'olive", "10ml"}}},
-        {"Collation", "16:00", "200 kcal", ":/images/snack_wed.png",
-         {{"Smoothie", "250ml"}, {"Épinards", "30g"}, {"Mangue", "80g"}}},
-        {"Dîner", "19:30", "480 kcal", ":/images/dinner_wed.png",
-         {{"Cabillaud", "120g"}, {"Haricots verts", "150g"}, {"Pommes de terre", "100g"}}}
+        {"Petit-déjeuner", "07:30", 400, ":/images/breakfast_wed.png",
+         {{"Flocons d'avoine", "50g"}, {"Banane", "1"}, {"Lait d'amande", "200ml"}, {"Graines de chia", "10g"}}, 18, 55, 12},
+        {"Déjeuner", "12:30", 550, ":/images/lunch_wed.png",
+         {{"Salade de lentilles", "150g"}, {"Feta", "50g"}, {"Concombre", "100g"}, {"Huile d'olive", "10ml"}}, 41, 62, 15},
+        {"Collation", "16:00", 200, ":/images/snack_wed.png",
+         {{"Smoothie", "250ml"}, {"Épinards", "30g"}, {"Mangue", "80g"}}, 8, 25, 8},
+        {"Dîner", "19:30", 480, ":/images/dinner_wed.png",
+         {{"Cabillaud", "120g"}, {"Haricots verts", "150g"}, {"Pommes de terre", "100g"}}, 42, 42, 16}
     };
 
     // JEUDI
     weeklyMeals[4] = {
-        {"Petit-déjeuner", "07:30", "370 kcal", ":/images/breakfast_thu.png",
-         {{"Pain aux céréales", "2 tranches"}, {"Fromage blanc", "100g"}, {"Miel", "15g"}, {"Noix", "10g"}}},
-        {"Déjeuner", "12:30", "500 kcal", ":/images/lunch_thu.png",
-         {{"Pâtes complètes", "80g"}, {"Sauce tomate", "100ml"}, {"Basilic frais", "5g"}, {"Parmesan", "20g"}}},
-        {"Collation", "16:00", "160 kcal", ":/images/snack_thu.png",
-         {{"Carotte", "100g"}, {"Hummus", "30g"}}},
-        {"Dîner", "19:30", "440 kcal", ":/images/dinner_thu.png",
-         {{"Bœuf maigre", "100g"}, {"Épinards", "150g"}, {"Quinoa", "60g"}}}
+        {"Petit-déjeuner", "07:30", 370, ":/images/breakfast_thu.png",
+         {{"Pain aux céréales", "2 tranches"}, {"Fromage blanc", "100g"}, {"Miel", "15g"}, {"Noix", "10g"}}, 17, 51, 11},
+        {"Déjeuner", "12:30", 500, ":/images/lunch_thu.png",
+         {{"Pâtes complètes", "80g"}, {"Sauce tomate", "100ml"}, {"Basilic frais", "5g"}, {"Parmesan", "20g"}}, 38, 56, 14},
+        {"Collation", "16:00", 160, ":/images/snack_thu.png",
+         {{"Carotte", "100g"}, {"Hummus", "30g"}}, 6, 20, 6},
+        {"Dîner", "19:30", 440, ":/images/dinner_thu.png",
+         {{"Bœuf maigre", "100g"}, {"Épinards", "150g"}, {"Quinoa", "60g"}}, 38, 38, 15}
     };
 
     // VENDREDI
     weeklyMeals[5] = {
-        {"Petit-déjeuner", "07:30", "390 kcal", ":/images/breakfast_fri.png",
-         {{"Smoothie bowl", "300ml"}, {"Granola", "30g"}, {"Fruits rouges", "80g"}}},
-        {"Déjeuner", "12:30", "530 kcal", ":/images/lunch_fri.png",
-         {{"Sushi bowl", "250g"}, {"Saumon cru", "80g"}, {"Avocat", "50g"}, {"Concombre", "50g"}}},
-        {"Collation", "16:00", "170 kcal", ":/images/snack_fri.png",
-         {{"Yaourt", "125g"}, {"Granola", "20g"}}},
-        {"Dîner", "19:30", "460 kcal", ":/images/dinner_fri.png",
-         {{"Crevettes", "120g"}, {"Légumes grillés", "200g"}, {"Riz sauvage", "60g"}}}
+        {"Petit-déjeuner", "07:30", 390, ":/images/breakfast_fri.png",
+         {{"Smoothie bowl", "300ml"}, {"Granola", "30g"}, {"Fruits rouges", "80g"}}, 18, 54, 12},
+        {"Déjeuner", "12:30", 530, ":/images/lunch_fri.png",
+         {{"Sushi bowl", "250g"}, {"Saumon cru", "80g"}, {"Avocat", "50g"}, {"Concombre", "50g"}}, 40, 60, 15},
+        {"Collation", "16:00", 170, ":/images/snack_fri.png",
+         {{"Yaourt", "125g"}, {"Granola", "20g"}}, 6, 21, 7},
+        {"Dîner", "19:30", 460, ":/images/dinner_fri.png",
+         {{"Crevettes", "120g"}, {"Légumes grillés", "200g"}, {"Riz sauvage", "60g"}}, 40, 40, 15}
     };
 
     // SAMEDI
     weeklyMeals[6] = {
-        {"Petit-déjeuner", "08:00", "420 kcal", ":/images/breakfast_sat.png",
-         {{"Pancakes", "2 pièces"}, {"Sirop d'érable", "15ml"}, {"Fruits frais", "100g"}}},
-        {"Déjeuner", "13:00", "580 kcal", ":/images/lunch_sat.png",
-         {{"Burger végétarien", "1"}, {"Frites de patate douce", "100g"}, {"Salade", "80g"}}},
-        {"Collation", "16:30", "190 kcal", ":/images/snack_sat.png",
-         {{"Trail mix", "40g"}}},
-        {"Dîner", "20:00", "490 kcal", ":/images/dinner_sat.png",
-         {{"Pizza maison", "2 parts"}, {"Salade verte", "100g"}}}
+        {"Petit-déjeuner", "08:00", 420, ":/images/breakfast_sat.png",
+         {{"Pancakes", "2 pièces"}, {"Sirop d'érable", "15ml"}, {"Fruits frais", "100g"}}, 19, 58, 13},
+        {"Déjeuner", "13:00", 580, ":/images/lunch_sat.png",
+         {{"Burger végétarien", "1"}, {"Frites de patate douce", "100g"}, {"Salade", "80g"}}, 44, 65, 16},
+        {"Collation", "16:30", 190, ":/images/snack_sat.png",
+         {{"Trail mix", "40g"}}, 7, 24, 7},
+        {"Dîner", "20:00", 490, ":/images/dinner_sat.png",
+         {{"Pizza maison", "2 parts"}, {"Salade verte", "100g"}}, 43, 43, 16}
     };
 
     // DIMANCHE
     weeklyMeals[7] = {
-        {"Petit-déjeuner", "08:30", "360 kcal", ":/images/breakfast_sun.png",
-         {{"Œufs brouillés", "2"}, {"Toast complet", "1"}, {"Épinards", "50g"}}},
-        {"Déjeuner", "13:30", "520 kcal", ":/images/lunch_sun.png",
-         {{"Rôti de porc", "100g"}, {"Légumes rôtis", "200g"}, {"Purée", "80g"}}},
-        {"Collation", "16:00", "140 kcal", ":/images/snack_sun.png",
-         {{"Thé", "250ml"}, {"Biscuits avoine", "2"}}},
-        {"Dîner", "19:00", "400 kcal", ":/images/dinner_sun.png",
-         {{"Soupe de légumes", "300ml"}, {"Pain complet", "1 tranche"}, {"Fromage", "30g"}}}
+        {"Petit-déjeuner", "08:30", 360, ":/images/breakfast_sun.png",
+         {{"Œufs brouillés", "2"}, {"Toast complet", "1"}, {"Épinards", "50g"}}, 16, 50, 11},
+        {"Déjeuner", "13:30", 520, ":/images/lunch_sun.png",
+         {{"Rôti de porc", "100g"}, {"Légumes rôtis", "200g"}, {"Purée", "80g"}}, 39, 58, 14},
+        {"Collation", "16:00", 140, ":/images/snack_sun.png",
+         {{"Thé", "250ml"}, {"Biscuits avoine", "2"}}, 5, 18, 5},
+        {"Dîner", "19:00", 400, ":/images/dinner_sun.png",
+         {{"Soupe de légumes", "300ml"}, {"Pain complet", "1 tranche"}, {"Fromage", "30g"}}, 35, 35, 13}
     };
 }
 
 void MealPlanView::initializeDefaultExercises() {
     // LUNDI
     weeklyExercises[1] = {
-        {"Course à pied", "30 min", "300 kcal", false},
-        {"Pompes", "15 min", "150 kcal", false},
-        {"Étirements", "10 min", "50 kcal", false}
+        {"Course à pied", "30 min", 300, false},
+        {"Pompes", "15 min", 150, false},
+        {"Étirements", "10 min", 50, false}
     };
 
     // MARDI
     weeklyExercises[2] = {
-        {"Vélo", "45 min", "400 kcal", false},
-        {"Abdominaux", "20 min", "180 kcal", false},
-        {"Yoga", "15 min", "80 kcal", false}
+        {"Vélo", "45 min", 400, false},
+        {"Abdominaux", "20 min", 180, false},
+        {"Yoga", "15 min", 80, false}
     };
 
     // MERCREDI
     weeklyExercises[3] = {
-        {"Natation", "40 min", "450 kcal", false},
-        {"Squats", "15 min", "160 kcal", false},
-        {"Méditation", "10 min", "30 kcal", false}
+        {"Natation", "40 min", 450, false},
+        {"Squats", "15 min", 160, false},
+        {"Méditation", "10 min", 30, false}
     };
 
     // JEUDI
     weeklyExercises[4] = {
-        {"Marche rapide", "60 min", "350 kcal", false},
-        {"Développé couché", "25 min", "200 kcal", false},
-        {"Relaxation", "15 min", "40 kcal", false}
+        {"Marche rapide", "60 min", 350, false},
+        {"Développé couché", "25 min", 200, false},
+        {"Relaxation", "15 min", 40, false}
     };
 
     // VENDREDI
     weeklyExercises[5] = {
-        {"Danse", "45 min", "380 kcal", false},
-        {"Burpees", "20 min", "220 kcal", false},
-        {"Étirements", "10 min", "50 kcal", false}
+        {"Danse", "45 min", 380, false},
+        {"Burpees", "20 min", 220, false},
+        {"Étirements", "10 min", 50, false}
     };
 
     // SAMEDI
     weeklyExercises[6] = {
-        {"Randonnée", "90 min", "500 kcal", false},
-        {"Pilates", "30 min", "180 kcal", false}
+        {"Randonnée", "90 min", 500, false},
+        {"Pilates", "30 min", 180, false}
     };
 
     // DIMANCHE
     weeklyExercises[7] = {
-        {"Repos actif", "30 min", "100 kcal", false},
-        {"Yoga doux", "20 min", "80 kcal", false}
+        {"Repos actif", "30 min", 100, false},
+        {"Yoga doux", "20 min", 80, false}
     };
 }
 
 
+namespace {
+// Repas et exercices lus en une seule tâche sur le thread base de données
+struct WeeklyPlanResult
+{
+    DbResult<AsyncDatabaseManager::MealsByDay> meals;
+    DbResult<AsyncDatabaseManager::ExercisesByDay> exercises;
+};
+}
+
 void MealPlanView::loadWeeklyMealsFromDatabase() {
-    DatabaseManager dbManager;
+    // Placeholder affiché jusqu'à la réception des données
+    if (!m_loadingLabel) {
+        m_loadingLabel = new QLabel("Chargement du plan de repas...");
+        m_loadingLabel->setAlignment(Qt::AlignCenter);
+        m_loadingLabel->setStyleSheet("color: #6c757d; font-size: 14px; padding: 20px;");
+        mainLayout->insertWidget(mainLayout->count() - 1, m_loadingLabel);
+    }
 
-    // Videz d'abord les données existantes
-    weeklyMeals.clear();
-    weeklyExercises.clear();
+    const int userId = m_userId;
+    AsyncDatabaseManager::instance().run([userId](DatabaseManager &dbManager) {
+        WeeklyPlanResult result;
+        result.meals.ok = dbManager.loadMeals(userId, result.meals.value);
+        result.exercises.ok = dbManager.loadExercises(userId, result.exercises.value);
+        return result;
+    }).then(this, [this](const WeeklyPlanResult &result) {
+        // Videz d'abord les données existantes
+        weeklyMeals.clear();
+        weeklyExercises.clear();
+
+        bool needsSave = false;
+        if (!result.meals.ok) {
+            qDebug() << "Failed to load meals from database, initializing defaults.";
+            initializeDefaultMeals();
+            needsSave = true;
+        } else {
+            weeklyMeals = result.meals.value;
+            qDebug() << "Successfully loaded meals from database";
+        }
 
-    if (!dbManager.loadMeals(m_userId, weeklyMeals)) {
-        qDebug() << "Failed to load meals from database, initializing defaults.";
-        initializeDefaultMeals();
-        saveWeeklyMealsToDatabase();
-    } else {
-        qDebug() << "Successfully loaded meals from database";
-    }
+        if (!result.exercises.ok) {
+            qDebug() << "Failed to load exercises from database, initializing defaults.";
+            initializeDefaultExercises();
+            needsSave = true;
+        } else {
+            weeklyExercises = result.exercises.value;
+            qDebug() << "Successfully loaded exercises from database";
+        }
 
-    if (!dbManager.loadExercises(m_userId, weeklyExercises)) {
-        qDebug() << "Failed to load exercises from database, initializing defaults.";
-        initializeDefaultExercises();
-        saveWeeklyMealsToDatabase();
-    } else {
-        qDebug() << "Successfully loaded exercises from database";
-    }
+        if (needsSave) {
+            saveWeeklyMealsToDatabase();
+        }
 
-    // Vérification finale
-    if (weeklyMeals.isEmpty()) {
-        qDebug() << "WARNING: weeklyMeals is still empty after loading/initialization!";
-        initializeDefaultMeals(); // Force l'initialisation
-    }
+        // Vérification finale
+        if (weeklyMeals.isEmpty()) {
+            qDebug() << "WARNING: weeklyMeals is still empty after loading/initialization!";
+            initializeDefaultMeals(); // Force l'initialisation
+        }
+
+        if (m_loadingLabel) {
+            m_loadingLabel->deleteLater();
+            m_loadingLabel = nullptr;
+        }
+        debugMealData();
+        updateMealsForCurrentDay();
+    });
 }
 // Ajoutez ces méthodes de debug dans votre classe MealPlanView
 
@@ -784,6 +854,5 @@ void MealPlanView::debugMealData() {
     qDebug() << "=====================";
 }
 void MealPlanView::forceRefresh() {
-    loadWeeklyMealsFromDatabase();
-    updateMealsForCurrentDay();
+    loadWeeklyMealsFromDatabase(); // updateMealsForCurrentDay() est appelé à réception
 }
@@ -12,21 +12,25 @@ class MealPlanView : public QWidget {
 public:
     explicit MealPlanView(int userId, QWidget *parent = nullptr);
     ~MealPlanView();
-    // Structure pour les informations des repas
+    // Structure pour les informations des repas.
+    // Valeurs numériques : le suffixe "kcal" / "g" n'est ajouté qu'à l'affichage.
     struct MealInfo {
         QString name;
         QString time;
-        QString calories;
+        int calories = 0;
         QString image;
         QList<QPair<QString, QString>> ingredients;
+        int proteinGrams = 0;
+        int carbsGrams = 0;
+        int fatGrams = 0;
     };
 
     // Structure pour les exercices
     struct ExerciseInfo {
         QString name;
         QString duration;
-        QString calories;
-        bool completed;
+        int calories = 0;
+        bool completed = false;
     };
 
 
@@ -41,6 +45,7 @@ private:
     void initializeDefaultExercises(); // AJOUTER CETTE LIGNE
     // Widgets principaux
     int m_userId;
+    QLabel *m_loadingLabel; // Placeholder pendant le chargement asynchrone
     QScrollArea *scrollArea;
     QWidget *contentWidget;
     QVBoxLayout *mainLayout;
@@ -56,6 +61,14 @@ private:
     QProgressBar *caloriesProgressBar;
     QWidget *macrosWidget;
 
+    // Éléments d'un macronutriment mis à jour par updateNutritionData()
+    struct MacroDisplay {
+        QLabel *percentLabel;
+        QProgressBar *progressBar;
+        QLabel *valueLabel;
+    };
+    QList<MacroDisplay> macroDisplays; // Protéines, glucides, lipides
+
     // Widget pour le suivi d'exercices
     QWidget *exerciseTrackWidget;
     QList<QPushButton*> exerciseButtons;
@@ -79,7 +92,7 @@ private:
     void forceRefresh();
     // Méthodes pour créer les widgets
     QWidget* createMealCard(const MealInfo &meal);
-    QWidget* createMacroWidget(const QString &name, int percentage, const QString &value, const QString &colorHex);
+    QWidget* createMacroWidget(const QString &name, const QString &colorHex);
 
     // Méthodes pour gérer les données
 
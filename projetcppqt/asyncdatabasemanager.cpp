@@ -0,0 +1,205 @@
+#include "asyncdatabasemanager.h"
+#include <QCoreApplication>
+
+AsyncDatabaseManager::AsyncDatabaseManager(QObject *parent)
+    : QObject(parent), m_context(new QObject)
+{
+    // Pool construit avant nous : détruit après l'arrêt de m_thread
+    ConnectionPool::instance();
+
+    m_thread.setObjectName("efitness-database");
+    m_context->moveToThread(&m_thread);
+    m_thread.start();
+
+    // Première tâche : la connexion d'écriture est créée et ouverte (schéma,
+    // migrations) sur le thread qui l'utilise
+    run([](DatabaseManager &db) {
+        return db.isOpen();
+    });
+
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                this, &AsyncDatabaseManager::shutdown);
+    }
+}
+
+AsyncDatabaseManager::~AsyncDatabaseManager()
+{
+    shutdown();
+}
+
+AsyncDatabaseManager& AsyncDatabaseManager::instance()
+{
+    static AsyncDatabaseManager instance;
+    return instance;
+}
+
+QFuture<bool> AsyncDatabaseManager::opened()
+{
+    // Les tâches s'exécutent dans l'ordre : celle-ci passe après l'ouverture du constructeur
+    return run([](DatabaseManager &db) {
+        return db.isOpen();
+    });
+}
+
+void AsyncDatabaseManager::shutdown()
+{
+    if (!m_context) {
+        return;
+    }
+
+    // Les vues vident leurs tampons d'écriture (write-behind) avant la fermeture
+    emit aboutToShutdown();
+
+    // Tâche placée en dernier dans la file : toutes les écritures en attente
+    // sont exécutées avant que la connexion ne soit fermée.
+    QMetaObject::invokeMethod(m_context, []() {
+        ConnectionPool::instance().releaseThreadConnections();
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread.quit();
+    m_thread.wait();
+
+    delete m_context;
+    m_context = nullptr;
+}
+
+QFuture<DbResult<AsyncDatabaseManager::MealsByDay>> AsyncDatabaseManager::loadMeals(int userId)
+{
+    return run([userId](DatabaseManager &db) {
+        DbResult<MealsByDay> result;
+        result.ok = db.loadMeals(userId, result.value);
+        return result;
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::saveMeal(int userId, int dayOfWeek, const MealPlanView::MealInfo &meal)
+{
+    return run([=](DatabaseManager &db) {
+        return db.saveMeal(userId, dayOfWeek, meal);
+    });
+}
+
+QFuture<DbResult<AsyncDatabaseManager::ExercisesByDay>> AsyncDatabaseManager::loadExercises(int userId)
+{
+    return run([userId](DatabaseManager &db) {
+        DbResult<ExercisesByDay> result;
+        result.ok = db.loadExercises(userId, result.value);
+        return result;
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::saveExercise(int userId, int dayOfWeek, const QString &name,
+                                                 const QString &duration, int calories, bool completed)
+{
+    return run([=](DatabaseManager &db) {
+        return db.saveExercise(userId, dayOfWeek, name, duration, calories, completed);
+    });
+}
+
+QFuture<DbResult<AsyncDatabaseManager::HabitRows>> AsyncDatabaseManager::loadHabits(int userId)
+{
+    return run([userId](DatabaseManager &db) {
+        DbResult<HabitRows> result;
+        result.ok = db.loadHabits(userId, result.value);
+        return result;
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::saveHabit(int userId, int habitId, const QString &name, int goalDays,
+                                              const CompletionBitmap &completedDates)
+{
+    return run([=](DatabaseManager &db) {
+        return db.saveHabit(userId, habitId, name, goalDays, completedDates);
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::deleteHabit(int userId, int habitId)
+{
+    return run([=](DatabaseManager &db) {
+        return db.deleteHabit(userId, habitId);
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::addHabitCompletion(int userId, int habitId, const QDate &date)
+{
+    return run([=](DatabaseManager &db) {
+        return db.addHabitCompletion(userId, habitId, date);
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::removeHabitCompletion(int userId, int habitId, const QDate &date)
+{
+    return run([=](DatabaseManager &db) {
+        return db.removeHabitCompletion(userId, habitId, date);
+    });
+}
+
+QFuture<DbResult<AsyncDatabaseManager::WaterData>> AsyncDatabaseManager::loadWaterData(int userId, const QString &date)
+{
+    return run([=](DatabaseManager &db) {
+        DbResult<WaterData> result;
+        result.ok = db.loadWaterData(userId, date, result.value.dailyGoal, result.value.currentAmount);
+        return result;
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::saveWaterData(int userId, const QString &date, int dailyGoal, int currentAmount)
+{
+    return run([=](DatabaseManager &db) {
+        return db.saveWaterData(userId, date, dailyGoal, currentAmount);
+    });
+}
+
+QFuture<DbResult<AsyncDatabaseManager::UserStats>> AsyncDatabaseManager::loadUserStats(int userId)
+{
+    return run([userId](DatabaseManager &db) {
+        DbResult<UserStats> result;
+        result.ok = db.loadUserStats(userId, result.value.workoutSessions, result.value.caloriesBurned,
+                                     result.value.activityMinutes, result.value.exercisesDone);
+        return result;
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::updateUserStats(int userId, const UserStats &stats)
+{
+    return run([=](DatabaseManager &db) {
+        return db.updateUserStats(userId, stats.workoutSessions, stats.caloriesBurned,
+                                  stats.activityMinutes, stats.exercisesDone);
+    });
+}
+
+QFuture<DbResult<QMap<QString, int>>> AsyncDatabaseManager::loadUserGoals(int userId)
+{
+    return run([userId](DatabaseManager &db) {
+        DbResult<QMap<QString, int>> result;
+        result.ok = db.loadUserGoals(userId, result.value);
+        return result;
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::saveUserGoals(int userId, const QMap<QString, int> &goals)
+{
+    return run([=](DatabaseManager &db) {
+        return db.saveUserGoals(userId, goals);
+    });
+}
+
+QFuture<bool> AsyncDatabaseManager::recordWorkoutEvent(int userId, const DatabaseManager::WorkoutEvent &event)
+{
+    return run([=](DatabaseManager &db) {
+        return db.recordWorkoutEvent(userId, event);
+    });
+}
+
+QFuture<DbResult<DatabaseManager::WorkoutRollup>> AsyncDatabaseManager::loadWorkoutRollup(int userId,
+                                                                                         DatabaseManager::RollupPeriod period,
+                                                                                         const QDate &date)
+{
+    // File d'écriture : l'agrégat inclut les événements mis en file avant la lecture
+    return run([=](DatabaseManager &db) {
+        DbResult<DatabaseManager::WorkoutRollup> result;
+        result.ok = db.loadWorkoutRollup(userId, period, date, result.value);
+        return result;
+    });
+}
@@ -0,0 +1,127 @@
+#ifndef ASYNCDATABASEMANAGER_H
+#define ASYNCDATABASEMANAGER_H
+
+#include <QObject>
+#include <QThread>
+#include <QFuture>
+#include <QPromise>
+#include <QSharedPointer>
+#include <type_traits>
+#include "databasemanager.h"
+#include "connectionpool.h"
+
+// Résultat d'un chargement asynchrone : ok vaut false si la requête a échoué
+template <typename T>
+struct DbResult
+{
+    bool ok = false;
+    T value;
+};
+
+// Façade asynchrone de DatabaseManager. Un thread dédié exécute les tâches avec
+// le bail d'écriture de ConnectionPool ; chaque appel est mis en file sur ce
+// thread et renvoie un QFuture. Les vues s'abonnent avec future.then(this, ...)
+// pour être rappelées sur le thread GUI. Les tâches s'exécutent dans l'ordre de
+// soumission. Les lectures qui ne peuvent suivre aucune écriture en file (session
+// de connexion) passent par ConnectionPool::read et tournent en parallèle.
+class AsyncDatabaseManager : public QObject
+{
+    Q_OBJECT
+public:
+    using MealsByDay = QMap<int, QList<MealPlanView::MealInfo>>;
+    using ExercisesByDay = QMap<int, QList<MealPlanView::ExerciseInfo>>;
+    using HabitRows = QMap<int, Habit>;
+
+    struct WaterData
+    {
+        int dailyGoal = 2000;
+        int currentAmount = 0;
+    };
+
+    struct UserStats
+    {
+        int workoutSessions = 0;
+        int caloriesBurned = 0;
+        int activityMinutes = 0;
+        int exercisesDone = 0;
+    };
+
+    static AsyncDatabaseManager& instance();
+    ~AsyncDatabaseManager();
+
+    // Exécute function(DatabaseManager&) sur le thread base de données.
+    // Permet de regrouper plusieurs appels (ex. dans une Transaction) en une seule tâche.
+    template <typename Function>
+    auto run(Function function) -> QFuture<std::invoke_result_t<Function, DatabaseManager&>>;
+
+    // Résolu (true si la connexion est ouverte) une fois le schéma créé et migré.
+    // Seul ce thread crée et migre le schéma ; un nouveau futur est rendu à chaque appel.
+    QFuture<bool> opened();
+
+    QFuture<DbResult<MealsByDay>> loadMeals(int userId);
+    QFuture<bool> saveMeal(int userId, int dayOfWeek, const MealPlanView::MealInfo &meal);
+    QFuture<DbResult<ExercisesByDay>> loadExercises(int userId);
+    QFuture<bool> saveExercise(int userId, int dayOfWeek, const QString &name, const QString &duration,
+                               int calories, bool completed);
+
+    QFuture<DbResult<HabitRows>> loadHabits(int userId);
+    QFuture<bool> saveHabit(int userId, int habitId, const QString &name, int goalDays,
+                            const CompletionBitmap &completedDates);
+    QFuture<bool> deleteHabit(int userId, int habitId);
+    QFuture<bool> addHabitCompletion(int userId, int habitId, const QDate &date);
+    QFuture<bool> removeHabitCompletion(int userId, int habitId, const QDate &date);
+
+    QFuture<DbResult<WaterData>> loadWaterData(int userId, const QString &date);
+    QFuture<bool> saveWaterData(int userId, const QString &date, int dailyGoal, int currentAmount);
+
+    QFuture<DbResult<UserStats>> loadUserStats(int userId);
+    QFuture<bool> updateUserStats(int userId, const UserStats &stats);
+    QFuture<DbResult<QMap<QString, int>>> loadUserGoals(int userId);
+    QFuture<bool> saveUserGoals(int userId, const QMap<QString, int> &goals);
+
+    QFuture<bool> recordWorkoutEvent(int userId, const DatabaseManager::WorkoutEvent &event);
+    QFuture<DbResult<DatabaseManager::WorkoutRollup>> loadWorkoutRollup(int userId, DatabaseManager::RollupPeriod period,
+                                                                        const QDate &date);
+
+    // Exécute les tâches encore en file puis arrête le thread (appelé sur aboutToQuit)
+    void shutdown();
+
+signals:
+    // Émis avant l'arrêt : dernière occasion de mettre en file des écritures en attente
+    void aboutToShutdown();
+
+private:
+    explicit AsyncDatabaseManager(QObject *parent = nullptr);
+    AsyncDatabaseManager(const AsyncDatabaseManager&) = delete;
+    AsyncDatabaseManager& operator=(const AsyncDatabaseManager&) = delete;
+
+    QThread m_thread;
+    QObject *m_context; // Vit sur m_thread : cible des tâches mises en file
+};
+
+template <typename Function>
+auto AsyncDatabaseManager::run(Function function) -> QFuture<std::invoke_result_t<Function, DatabaseManager&>>
+{
+    using Result = std::invoke_result_t<Function, DatabaseManager&>;
+
+    auto promise = QSharedPointer<QPromise<Result>>::create();
+    QFuture<Result> future = promise->future();
+    promise->start();
+
+    if (!m_context) {
+        // Thread déjà arrêté : résultat par défaut (false / ok = false)
+        promise->addResult(Result());
+        promise->finish();
+        return future;
+    }
+
+    QMetaObject::invokeMethod(m_context, [promise, function]() mutable {
+        // Connexion d'écriture de m_thread, exclusive pendant la tâche
+        ConnectionPool::Writer writer(ConnectionPool::instance());
+        promise->addResult(function(*writer));
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+}
+
+#endif // ASYNCDATABASEMANAGER_H
@@ -0,0 +1,294 @@
+#include "completionbitmap.h"
+#include <QtAlgorithms>
+
+namespace {
+// Bits [first, last] (inclus) des mots d'une année
+int countBits(const std::array<quint64, CompletionBitmap::kWordsPerYear> &words, int first, int last)
+{
+    int total = 0;
+    for (int word = first / 64; word <= last / 64; ++word) {
+        quint64 mask = ~quint64(0);
+        if (word == first / 64) {
+            mask &= ~quint64(0) << (first % 64);
+        }
+        if (word == last / 64) {
+            mask &= ~quint64(0) >> (63 - last % 64);
+        }
+        total += int(qPopulationCount(words[word] & mask));
+    }
+    return total;
+}
+}
+
+bool CompletionBitmap::isEmpty() const
+{
+    // trim() garantit que les années extrêmes ne sont jamais vides
+    return m_years.isEmpty();
+}
+
+bool CompletionBitmap::contains(const QDate &date) const
+{
+    const Words *words = date.isValid() ? wordsFor(date.year()) : nullptr;
+    if (!words) {
+        return false;
+    }
+    const int bit = date.dayOfYear() - 1;
+    return ((*words)[bit / 64] >> (bit % 64)) & 1;
+}
+
+void CompletionBitmap::insert(const QDate &date)
+{
+    if (!date.isValid()) {
+        return;
+    }
+    const int bit = date.dayOfYear() - 1;
+    wordsForWrite(date.year())[bit / 64] |= quint64(1) << (bit % 64);
+}
+
+void CompletionBitmap::remove(const QDate &date)
+{
+    if (!contains(date)) {
+        return;
+    }
+    const int bit = date.dayOfYear() - 1;
+    m_years[date.year() - m_firstYear][bit / 64] &= ~(quint64(1) << (bit % 64));
+    trim();
+}
+
+void CompletionBitmap::clear()
+{
+    m_years.clear();
+    m_firstYear = 0;
+}
+
+int CompletionBitmap::count() const
+{
+    int total = 0;
+    for (const Words &words : m_years) {
+        for (quint64 word : words) {
+            total += int(qPopulationCount(word));
+        }
+    }
+    return total;
+}
+
+int CompletionBitmap::count(const QDate &from, const QDate &to) const
+{
+    if (!from.isValid() || !to.isValid() || from > to) {
+        return 0;
+    }
+
+    int total = 0;
+    for (int year = from.year(); year <= to.year(); ++year) {
+        const Words *words = wordsFor(year);
+        if (!words) {
+            continue;
+        }
+        const int first = (year == from.year()) ? from.dayOfYear() - 1 : 0;
+        const int last = (year == to.year()) ? to.dayOfYear() - 1 : kWordsPerYear * 64 - 1;
+        total += countBits(*words, first, last);
+    }
+    return total;
+}
+
+int CompletionBitmap::streakEndingAt(const QDate &date) const
+{
+    if (!date.isValid()) {
+        return 0;
+    }
+
+    int streak = 0;
+    int year = date.year();
+    int bit = date.dayOfYear() - 1;
+    for (;;) {
+        const Words *words = wordsFor(year);
+        if (!words) {
+            return streak;
+        }
+
+        // Mot par mot en remontant : le bit de départ est aligné sur le bit de poids
+        // fort, les uns consécutifs se comptent alors avec un seul clz
+        for (int word = bit / 64, offset = bit % 64; word >= 0; --word, offset = 63) {
+            const quint64 aligned = (*words)[word] << (63 - offset);
+            const int ones = int(qCountLeadingZeroBits(~aligned));
+            streak += ones;
+            if (ones <= offset) {
+                return streak;
+            }
+        }
+
+        // 1er janvier validé : la série continue le 31 décembre précédent
+        --year;
+        bit = QDate(year, 12, 31).dayOfYear() - 1;
+    }
+}
+
+CompletionBitmap CompletionBitmap::intersected(const CompletionBitmap &other) const
+{
+    CompletionBitmap result;
+    const int first = qMax(m_firstYear, other.m_firstYear);
+    const int last = qMin(m_firstYear + int(m_years.size()), other.m_firstYear + int(other.m_years.size())) - 1;
+    if (isEmpty() || other.isEmpty() || first > last) {
+        return result;
+    }
+
+    result.m_firstYear = first;
+    result.m_years.resize(last - first + 1);
+    for (int year = first; year <= last; ++year) {
+        const Words &left = m_years[year - m_firstYear];
+        const Words &right = other.m_years[year - other.m_firstYear];
+        Words &words = result.m_years[year - first];
+        for (int i = 0; i < kWordsPerYear; ++i) {
+            words[i] = left[i] & right[i];
+        }
+    }
+    result.trim();
+    return result;
+}
+
+void CompletionBitmap::unite(const CompletionBitmap &other)
+{
+    for (int i = 0; i < other.m_years.size(); ++i) {
+        const Words &source = other.m_years[i];
+        Words &words = wordsForWrite(other.m_firstYear + i);
+        for (int word = 0; word < kWordsPerYear; ++word) {
+            words[word] |= source[word];
+        }
+    }
+    trim();
+}
+
+CompletionBitmap::YearSummary CompletionBitmap::summary(int year) const
+{
+    YearSummary result;
+    const Words *words = wordsFor(year);
+    if (!words) {
+        return result;
+    }
+
+    const int days = QDate(year, 12, 31).dayOfYear();
+    int run = 0;
+    for (int bit = 0; bit < days; ++bit) {
+        if (((*words)[bit / 64] >> (bit % 64)) & 1) {
+            result.completedDays++;
+            run++;
+            result.longestRun = qMax(result.longestRun, run);
+        } else {
+            if (result.leadingRun == 0 && run == bit) {
+                result.leadingRun = run; // Première interruption : fin de la série du 1er janvier
+            }
+            run = 0;
+        }
+    }
+    if (run == days) {
+        result.leadingRun = days; // Année complète
+    }
+    result.trailingRun = run;
+    return result;
+}
+
+QList<QDate> CompletionBitmap::dates() const
+{
+    QList<QDate> result;
+    result.reserve(count());
+    for (int i = 0; i < m_years.size(); ++i) {
+        const QDate firstDay(m_firstYear + i, 1, 1);
+        for (int word = 0; word < kWordsPerYear; ++word) {
+            // Parcours des seuls bits à 1 : v & (v - 1) efface le plus faible
+            for (quint64 value = m_years[i][word]; value; value &= value - 1) {
+                result.append(firstDay.addDays(word * 64 + int(qCountTrailingZeroBits(value))));
+            }
+        }
+    }
+    return result;
+}
+
+QList<int> CompletionBitmap::years() const
+{
+    QList<int> result;
+    for (int i = 0; i < m_years.size(); ++i) {
+        const Words &words = m_years[i];
+        for (quint64 word : words) {
+            if (word) {
+                result.append(m_firstYear + i);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+QByteArray CompletionBitmap::yearBlob(int year) const
+{
+    QByteArray blob(kBlobBytes, '\0');
+    const Words *words = wordsFor(year);
+    if (words) {
+        for (int i = 0; i < kBlobBytes; ++i) {
+            blob[i] = char(((*words)[i / 8] >> ((i % 8) * 8)) & 0xFF);
+        }
+    }
+    return blob;
+}
+
+void CompletionBitmap::setYearBlob(int year, const QByteArray &blob)
+{
+    Words words{};
+    const int size = qMin(int(blob.size()), kBlobBytes);
+    for (int i = 0; i < size; ++i) {
+        words[i / 8] |= quint64(quint8(blob[i])) << ((i % 8) * 8);
+    }
+
+    Words &target = wordsForWrite(year);
+    target = words;
+    trim();
+}
+
+const CompletionBitmap::Words *CompletionBitmap::wordsFor(int year) const
+{
+    const int index = year - m_firstYear;
+    if (index < 0 || index >= m_years.size()) {
+        return nullptr;
+    }
+    return &m_years[index];
+}
+
+CompletionBitmap::Words &CompletionBitmap::wordsForWrite(int year)
+{
+    if (m_years.isEmpty()) {
+        m_firstYear = year;
+        m_years.resize(1);
+    } else if (year < m_firstYear) {
+        m_years.insert(0, m_firstYear - year, Words{});
+        m_firstYear = year;
+    } else if (year - m_firstYear >= m_years.size()) {
+        m_years.resize(year - m_firstYear + 1);
+    }
+    return m_years[year - m_firstYear];
+}
+
+void CompletionBitmap::trim()
+{
+    auto isEmptyYear = [](const Words &words) {
+        for (quint64 word : words) {
+            if (word) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    while (!m_years.isEmpty() && isEmptyYear(m_years.last())) {
+        m_years.removeLast();
+    }
+    int leading = 0;
+    while (leading < m_years.size() && isEmptyYear(m_years[leading])) {
+        ++leading;
+    }
+    if (leading > 0) {
+        m_years.remove(0, leading);
+        m_firstYear += leading;
+    }
+    if (m_years.isEmpty()) {
+        m_firstYear = 0;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef COMPLETIONBITMAP_H
+#define COMPLETIONBITMAP_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QList>
+#include <QVector>
+#include <array>
+
+// Historique des jours validés d'une habitude : un bitmap de 366 bits par année
+// (bit j - 1 = jour j de l'année), stocké en mots de 64 bits. Les années se
+// suivent dans un tableau contigu : 48 octets par année d'historique.
+// Séries, comptages et intersections (journées parfaites) travaillent mot par mot.
+class CompletionBitmap
+{
+public:
+    static constexpr int kWordsPerYear = 6; // 384 bits >= 366 jours
+    static constexpr int kBlobBytes = 46;   // Forme persistée : 366 bits arrondis à l'octet
+
+    // Résumé d'une année, persisté à côté de son blob : permet de calculer séries
+    // et records sans charger les années anciennes
+    struct YearSummary
+    {
+        int completedDays = 0;
+        int longestRun = 0;
+        int leadingRun = 0;   // Série commençant le 1er janvier
+        int trailingRun = 0;  // Série se terminant le 31 décembre
+    };
+
+    bool isEmpty() const;
+    bool contains(const QDate &date) const;
+    void insert(const QDate &date);
+    void remove(const QDate &date);
+    void clear();
+
+    int count() const;                                     // Nombre total de jours validés
+    int count(const QDate &from, const QDate &to) const;   // Jours validés dans [from, to]
+    int streakEndingAt(const QDate &date) const;           // Jours consécutifs validés jusqu'à date incluse
+    CompletionBitmap intersected(const CompletionBitmap &other) const;
+    void unite(const CompletionBitmap &other);
+    YearSummary summary(int year) const;
+    QList<QDate> dates() const;                            // Ordre chronologique
+
+    // Persistance : une ligne (année, blob de kBlobBytes octets) par année non vide,
+    // octet i = jours 8i + 1 à 8i + 8, bit de poids faible en premier
+    QList<int> years() const;
+    QByteArray yearBlob(int year) const;
+    void setYearBlob(int year, const QByteArray &blob);
+
+private:
+    using Words = std::array<quint64, kWordsPerYear>;
+
+    const Words *wordsFor(int year) const;
+    Words &wordsForWrite(int year); // Étend le tableau si nécessaire
+    void trim();                    // Retire les années vides aux extrémités
+
+    int m_firstYear = 0;
+    QVector<Words> m_years; // m_years[i] = année m_firstYear + i
+};
+
+#endif // COMPLETIONBITMAP_H
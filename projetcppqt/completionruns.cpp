@@ -0,0 +1,141 @@
+#include "completionruns.h"
+#include <iterator>
+
+CompletionRuns CompletionRuns::fromBitmap(const CompletionBitmap &bitmap)
+{
+    CompletionRuns runs;
+    qint64 start = 0;
+    int length = 0;
+    for (const QDate &date : bitmap.dates()) {
+        const qint64 day = date.toJulianDay();
+        if (length > 0 && day == start + length) {
+            length++;
+            continue;
+        }
+        if (length > 0) {
+            runs.addRun(start, length);
+        }
+        start = day;
+        length = 1;
+    }
+    if (length > 0) {
+        runs.addRun(start, length);
+    }
+    return runs;
+}
+
+void CompletionRuns::insert(const QDate &date)
+{
+    if (!date.isValid() || contains(date)) {
+        return;
+    }
+
+    const qint64 day = date.toJulianDay();
+    auto next = m_runs.upperBound(day);
+    auto previous = (next != m_runs.begin()) ? std::prev(next) : m_runs.end();
+    const bool joinsPrevious = previous != m_runs.end() && previous.key() + previous.value() == day;
+    const bool joinsNext = next != m_runs.end() && next.key() == day + 1;
+
+    // La nouvelle date prolonge, relie ou crée une série
+    qint64 start = day;
+    int length = 1;
+    if (joinsPrevious) {
+        start = previous.key();
+        length += previous.value();
+    }
+    if (joinsNext) {
+        length += next.value();
+        removeRun(next);
+    }
+    if (joinsPrevious) {
+        removeRun(m_runs.find(start));
+    }
+    addRun(start, length);
+}
+
+void CompletionRuns::remove(const QDate &date)
+{
+    if (!date.isValid()) {
+        return;
+    }
+
+    const qint64 day = date.toJulianDay();
+    auto run = m_runs.upperBound(day);
+    if (run == m_runs.begin()) {
+        return;
+    }
+    --run;
+    const qint64 start = run.key();
+    const int length = run.value();
+    if (day >= start + length) {
+        return;
+    }
+
+    // La série est coupée en deux autour de la date retirée
+    removeRun(run);
+    if (day > start) {
+        addRun(start, int(day - start));
+    }
+    if (day < start + length - 1) {
+        addRun(day + 1, int(start + length - 1 - day));
+    }
+}
+
+int CompletionRuns::streakAt(const QDate &date) const
+{
+    if (!date.isValid()) {
+        return 0;
+    }
+
+    const qint64 day = date.toJulianDay();
+    auto run = m_runs.upperBound(day);
+    if (run == m_runs.begin()) {
+        return 0;
+    }
+    --run;
+    return day < run.key() + run.value() ? int(day - run.key()) + 1 : 0;
+}
+
+int CompletionRuns::runLength(const QDate &date) const
+{
+    if (!date.isValid()) {
+        return 0;
+    }
+
+    const qint64 day = date.toJulianDay();
+    auto run = m_runs.upperBound(day);
+    if (run == m_runs.begin()) {
+        return 0;
+    }
+    --run;
+    return day < run.key() + run.value() ? run.value() : 0;
+}
+
+int CompletionRuns::longest() const
+{
+    return m_lengths.isEmpty() ? 0 : m_lengths.lastKey();
+}
+
+int CompletionRuns::runsAtLeast(int days) const
+{
+    int total = 0;
+    for (auto it = m_lengths.lowerBound(days); it != m_lengths.end(); ++it) {
+        total += it.value();
+    }
+    return total;
+}
+
+void CompletionRuns::addRun(qint64 start, int length)
+{
+    m_runs.insert(start, length);
+    m_lengths[length]++;
+}
+
+void CompletionRuns::removeRun(QMap<qint64, int>::iterator run)
+{
+    auto count = m_lengths.find(run.value());
+    if (count != m_lengths.end() && --count.value() == 0) {
+        m_lengths.erase(count);
+    }
+    m_runs.erase(run);
+}
@@ -0,0 +1,37 @@
+#ifndef COMPLETIONRUNS_H
+#define COMPLETIONRUNS_H
+
+#include <QDate>
+#include <QMap>
+#include "completionbitmap.h"
+
+// Historique d'une habitude en séries (run-length) : chaque suite de jours
+// consécutifs validés est une entrée (premier jour, longueur). Les séries sont
+// indexées par leur premier jour et leurs longueurs sont comptées dans un
+// histogramme trié : record, série à une date passée et distribution des
+// longueurs se lisent en O(log n) sans reparcourir l'historique.
+class CompletionRuns
+{
+public:
+    static CompletionRuns fromBitmap(const CompletionBitmap &bitmap);
+
+    void insert(const QDate &date);
+    void remove(const QDate &date);
+
+    bool contains(const QDate &date) const { return streakAt(date) > 0; }
+    int streakAt(const QDate &date) const;  // Série en cours à cette date (0 si non validée)
+    int runLength(const QDate &date) const; // Longueur totale de la série contenant date
+    int longest() const;                    // Record de tous les temps
+    int runCount() const { return int(m_runs.size()); }
+    int runsAtLeast(int days) const;        // Séries d'au moins days jours
+    QMap<int, int> lengthDistribution() const { return m_lengths; } // Longueur -> nombre de séries
+
+private:
+    void addRun(qint64 start, int length);
+    void removeRun(QMap<qint64, int>::iterator run);
+
+    QMap<qint64, int> m_runs;    // Premier jour (jour julien) -> longueur
+    QMap<int, int> m_lengths;    // Longueur -> nombre de séries de cette longueur
+};
+
+#endif // COMPLETIONRUNS_H
@@ -0,0 +1,104 @@
+#include "connectionpool.h"
+#include <QThread>
+#include <QDebug>
+
+ConnectionPool::ConnectionPool()
+    : m_maxReaders(qMax(2, QThread::idealThreadCount())), m_readerPermits(m_maxReaders)
+{
+    // Un thread du pool par lecteur possible : aucune tâche n'attend un permis
+    // alors qu'un thread est libre.
+    m_threadPool.setMaxThreadCount(m_maxReaders);
+    m_threadPool.setObjectName("efitness-readers");
+}
+
+ConnectionPool& ConnectionPool::instance()
+{
+    static ConnectionPool instance;
+    return instance;
+}
+
+ConnectionPool::ThreadConnections::~ThreadConnections()
+{
+    // Exécuté sur le thread propriétaire à sa terminaison (QThreadStorage)
+    delete reader;
+    delete writer;
+}
+
+ConnectionPool::ThreadConnections *ConnectionPool::threadConnections()
+{
+    if (!m_connections.hasLocalData()) {
+        m_connections.setLocalData(new ThreadConnections);
+    }
+    return m_connections.localData();
+}
+
+void ConnectionPool::releaseThreadConnections()
+{
+    // setLocalData détruit les connexions précédentes du thread
+    if (m_connections.hasLocalData()) {
+        m_connections.setLocalData(nullptr);
+    }
+}
+
+QMap<QString, DatabaseManager::StatementCacheStats> ConnectionPool::readerCacheStats() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_readerStats;
+}
+
+ConnectionPool::Reader::Reader(ConnectionPool &pool)
+    : m_pool(pool), m_manager(nullptr), m_ownsPermit(false)
+{
+    ThreadConnections *connections = m_pool.threadConnections();
+
+    // Un bail imbriqué sur le même thread réutilise le permis déjà obtenu
+    if (connections->readerDepth == 0) {
+        m_pool.m_readerPermits.acquire();
+        m_ownsPermit = true;
+    }
+    connections->readerDepth++;
+
+    if (!connections->reader) {
+        const QString name = QString("efitness_reader_%1")
+                                 .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+        connections->reader = new DatabaseManager(name, DatabaseManager::ReadOnly);
+    }
+    m_manager = connections->reader;
+    if (!m_manager->isOpen() && !m_manager->openDatabase()) {
+        qDebug() << "Erreur lors de l'ouverture de la connexion de lecture";
+    }
+}
+
+ConnectionPool::Reader::~Reader()
+{
+    m_pool.threadConnections()->readerDepth--;
+    if (m_ownsPermit) {
+        {
+            QMutexLocker locker(&m_pool.m_statsMutex);
+            m_pool.m_readerStats.insert(m_manager->connectionName(), m_manager->statementCacheStats());
+        }
+        m_pool.m_readerPermits.release();
+    }
+}
+
+ConnectionPool::Writer::Writer(ConnectionPool &pool)
+    : m_pool(pool), m_manager(nullptr)
+{
+    m_pool.m_writerMutex.lock();
+
+    ThreadConnections *connections = m_pool.threadConnections();
+    if (!connections->writer) {
+        const QString name = QString("efitness_writer_%1")
+                                 .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+        connections->writer = new DatabaseManager(name, DatabaseManager::ReadWrite);
+    }
+    m_manager = connections->writer;
+    if (!m_manager->isOpen() && !m_manager->openDatabase()) {
+        qDebug() << "Erreur lors de l'ouverture de la connexion d'écriture";
+    }
+}
+
+ConnectionPool::Writer::~Writer()
+{
+    m_pool.m_writerMutex.unlock();
+}
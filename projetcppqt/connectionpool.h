@@ -0,0 +1,120 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QObject>
+#include <QThreadStorage>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QRecursiveMutex>
+#include <QMutex>
+#include <QMap>
+#include <QFuture>
+#include <QPromise>
+#include <QSharedPointer>
+#include <type_traits>
+#include "databasemanager.h"
+
+// Pool de connexions SQLite par thread. QSqlDatabase ne peut pas être partagée
+// entre threads : chaque thread reçoit ses propres connexions nommées vers le
+// même fichier. Les lecteurs travaillent en parallèle (WAL) via read() ; les
+// écrivains passent un par un derrière un verrou unique. AsyncDatabaseManager
+// exécute toutes ses tâches avec le bail d'écriture : c'est la seule connexion
+// de l'application qui écrit (et qui crée et migre le schéma).
+class ConnectionPool
+{
+public:
+    static ConnectionPool& instance();
+
+    // Bail de lecture : connexion en lecture seule du thread courant.
+    // Bloque si maxReaders() lecteurs sont déjà actifs.
+    class Reader
+    {
+    public:
+        explicit Reader(ConnectionPool &pool);
+        ~Reader();
+        DatabaseManager *operator->() const { return m_manager; }
+        DatabaseManager &operator*() const { return *m_manager; }
+
+    private:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        ConnectionPool &m_pool;
+        DatabaseManager *m_manager;
+        bool m_ownsPermit;
+    };
+
+    // Bail d'écriture : connexion en lecture/écriture du thread courant,
+    // exclusive entre tous les threads du pool pendant sa durée de vie.
+    class Writer
+    {
+    public:
+        explicit Writer(ConnectionPool &pool);
+        ~Writer();
+        DatabaseManager *operator->() const { return m_manager; }
+        DatabaseManager &operator*() const { return *m_manager; }
+
+    private:
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        ConnectionPool &m_pool;
+        DatabaseManager *m_manager;
+    };
+
+    // Exécute function(DatabaseManager&) sur un thread du pool avec un bail de lecture
+    template <typename Function>
+    auto read(Function function) -> QFuture<std::invoke_result_t<Function, DatabaseManager&>>;
+
+    int maxReaders() const { return m_maxReaders; }
+
+    // Ferme les connexions du thread courant (à appeler sur ce thread, hors de tout bail)
+    void releaseThreadConnections();
+
+    // Cache de requêtes de chaque connexion de lecture (clé : nom de connexion),
+    // relevé à la fin de chaque bail : lisible depuis n'importe quel thread
+    QMap<QString, DatabaseManager::StatementCacheStats> readerCacheStats() const;
+
+private:
+    ConnectionPool();
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Connexions du thread courant, fermées et détruites à la fin du thread
+    struct ThreadConnections
+    {
+        DatabaseManager *reader = nullptr;
+        DatabaseManager *writer = nullptr;
+        int readerDepth = 0; // Bails de lecture imbriqués sur ce thread
+        ~ThreadConnections();
+    };
+    ThreadConnections *threadConnections();
+
+    const int m_maxReaders;
+    QSemaphore m_readerPermits;
+    QRecursiveMutex m_writerMutex;
+    mutable QMutex m_statsMutex;
+    QMap<QString, DatabaseManager::StatementCacheStats> m_readerStats;
+    // Déclaré avant m_threadPool : détruit après lui, une fois les threads du pool terminés
+    QThreadStorage<ThreadConnections*> m_connections;
+    QThreadPool m_threadPool;
+};
+
+template <typename Function>
+auto ConnectionPool::read(Function function) -> QFuture<std::invoke_result_t<Function, DatabaseManager&>>
+{
+    using Result = std::invoke_result_t<Function, DatabaseManager&>;
+
+    auto promise = QSharedPointer<QPromise<Result>>::create();
+    QFuture<Result> future = promise->future();
+    promise->start();
+
+    m_threadPool.start([this, promise, function]() mutable {
+        Reader reader(*this);
+        promise->addResult(function(*reader));
+        promise->finish();
+    });
+    return future;
+}
+
+#endif // CONNECTIONPOOL_H
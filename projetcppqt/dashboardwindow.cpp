@@ -1,10 +1,16 @@
 #include "dashboardwindow.h"
 #include "databasemanager.h"
+#include "asyncdatabasemanager.h"
+#include "querymetrics.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QTime>
 #include <QDateTime>
 #include <QMessageBox>
+#include <QShortcut>
+#include <QDialog>
+#include <QTableWidget>
+#include <QHeaderView>
 
 // Constructeur par défaut
 DashboardWindow::DashboardWindow(QWidget *parent) : QMainWindow(parent) {
@@ -43,14 +49,13 @@ DashboardWindow::DashboardWindow(const UserInfo& userInfo, QWidget *parent) : QM
     caloriesPerMinute = 5;
     exerciseInProgress = false;
 
-    // 1. Initialiser currentUser avec les infos de la connexion
+    // 1. Initialiser currentUser avec l'instantané complet de la connexion
+    //    (statistiques et objectifs inclus : pas de nouvelle lecture en base)
     currentUser = userInfo;
 
-    // 2. Charger le reste des données depuis la DB
-    loadUserData();
-
-    // 3. Construire l'interface graphique (qui utilisera les données chargées)
+    // 2. Construire l'interface graphique (qui utilisera les données chargées)
     setupUI();
+    loadWeeklyRollup();
     showMaximized();
 }
 void DashboardWindow::setupExercisesList() {
@@ -118,6 +123,11 @@ void DashboardWindow::setupUI() {
     mainLayout->addWidget(navSidebar, 1);
     mainLayout->addWidget(mainContent, 10);
     mainLayout->addWidget(rightSidebar, 2);
+
+    // Panneau développeur caché (pas d'entrée dans la navigation)
+    QShortcut *developerShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(developerShortcut, &QShortcut::activated, this, &DashboardWindow::showDeveloperPanel);
+
     showMaximized();
 }
 
@@ -305,9 +315,9 @@ void DashboardWindow::setupRightSidebar() {
 
     QStringList statNames = {"Séances d'entraînement", "Calories brûlées", "Minutes d'activité"};
     QStringList statValues = {
-        QString("%1 cette semaine").arg(currentUser.workoutSessions),
-        QString("%1 kcal").arg(currentUser.caloriesBurned),
-        QString("%1 min").arg(currentUser.activityMinutes)
+        QString("%1 cette semaine").arg(weekRollup.sessions),
+        QString("%1 kcal cette semaine").arg(weekRollup.calories),
+        QString("%1 min cette semaine").arg(weekRollup.activeSeconds / 60)
     };
 
     for (int i = 0; i < statNames.size(); ++i) {
@@ -928,6 +938,7 @@ void DashboardWindow::updateTimer() {
             int seriesCalories = (elapsed / 60.0) * caloriesPerMinute;
             currentUser.caloriesBurned += seriesCalories;
             currentUser.activityMinutes += elapsed / 60;
+            recordWorkoutEvent(DatabaseManager::WorkoutEventType::Set, elapsed, seriesCalories);
             updateStatisticsDisplay();
         }
 
@@ -981,10 +992,163 @@ void DashboardWindow::updateUserStats() {
     }
 
     currentUser.goals["Perte de poids"] = qMin(100, currentUser.goals["Perte de poids"] + 5);
+    recordWorkoutEvent(DatabaseManager::WorkoutEventType::Session, exerciseDuration, caloriesBurned);
     saveUserStats();
     animateStats();
 }
 
+void DashboardWindow::recordWorkoutEvent(DatabaseManager::WorkoutEventType type, int durationSeconds, int calories)
+{
+    if (currentUser.userId == -1) {
+        return;
+    }
+
+    DatabaseManager::WorkoutEvent event;
+    event.type = type;
+    event.exerciseName = exercisesList[currentExerciseIndex].name;
+    event.occurredAt = QDateTime::currentDateTime();
+    event.durationSeconds = durationSeconds;
+    event.calories = calories;
+    AsyncDatabaseManager::instance().recordWorkoutEvent(currentUser.userId, event);
+
+    // Même règle que le trigger SQL : inutile de relire l'agrégat. Pendant un chargement,
+    // l'événement est aussi retenu à part : il est en file après la lecture, absent de son résultat
+    auto addEvent = [&](DatabaseManager::WorkoutRollup &rollup) {
+        if (type == DatabaseManager::WorkoutEventType::Session) {
+            rollup.sessions++;
+            rollup.calories += calories;
+            rollup.activeSeconds += durationSeconds;
+        } else {
+            rollup.sets++;
+        }
+    };
+    addEvent(weekRollup);
+    if (weekRollupLoading) {
+        addEvent(weekRollupSinceLoad);
+    }
+}
+
+void DashboardWindow::loadWeeklyRollup()
+{
+    if (currentUser.userId == -1) {
+        return;
+    }
+
+    weekRollupSinceLoad = DatabaseManager::WorkoutRollup();
+    weekRollupLoading = true;
+    AsyncDatabaseManager::instance()
+        .loadWorkoutRollup(currentUser.userId, DatabaseManager::RollupPeriod::Week, QDate::currentDate())
+        .then(this, [this](const DbResult<DatabaseManager::WorkoutRollup> &result) {
+            weekRollupLoading = false;
+            if (result.ok) {
+                // Lecture dans la file d'écriture : elle voit les événements soumis avant elle,
+                // ceux enregistrés depuis sont ajoutés sans écraser les incréments locaux
+                weekRollup = result.value;
+                weekRollup.sessions += weekRollupSinceLoad.sessions;
+                weekRollup.sets += weekRollupSinceLoad.sets;
+                weekRollup.calories += weekRollupSinceLoad.calories;
+                weekRollup.activeSeconds += weekRollupSinceLoad.activeSeconds;
+                updateStatisticsDisplay();
+            }
+        });
+}
+
+void DashboardWindow::showDeveloperPanel()
+{
+    QDialog *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle("Métriques des requêtes");
+    dialog->resize(900, 500);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+
+    QTableWidget *table = new QTableWidget(dialog);
+    table->setColumnCount(8);
+    table->setHorizontalHeaderLabels({"Opération", "Appels", "Échecs", "Lignes",
+                                      "Moy. (ms)", "p50 (ms)", "p95 (ms)", "Max (ms)"});
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    table->verticalHeader()->setVisible(false);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSortingEnabled(true);
+    layout->addWidget(table);
+
+    QLabel *cacheLabel = new QLabel(dialog);
+    layout->addWidget(cacheLabel);
+
+    QHBoxLayout *buttonsLayout = new QHBoxLayout();
+    QPushButton *refreshButton = new QPushButton("Actualiser", dialog);
+    QPushButton *resetButton = new QPushButton("Réinitialiser", dialog);
+    QPushButton *exportButton = new QPushButton("Exporter JSON", dialog);
+    buttonsLayout->addWidget(refreshButton);
+    buttonsLayout->addWidget(resetButton);
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(exportButton);
+    layout->addLayout(buttonsLayout);
+
+    auto refresh = [table, cacheLabel]() {
+        const QMap<QString, QueryMetrics::OperationStats> operations = QueryMetrics::instance().snapshot();
+        table->setSortingEnabled(false);
+        table->setRowCount(operations.size());
+
+        auto numberItem = [](double value, int decimals) {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setData(Qt::DisplayRole, decimals == 0 ? QVariant(qlonglong(value)) : QVariant(QString::number(value, 'f', decimals).toDouble()));
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            return item;
+        };
+
+        int row = 0;
+        for (auto it = operations.constBegin(); it != operations.constEnd(); ++it, ++row) {
+            const QueryMetrics::OperationStats &stats = it.value();
+            table->setItem(row, 0, new QTableWidgetItem(it.key()));
+            table->setItem(row, 1, numberItem(stats.calls, 0));
+            table->setItem(row, 2, numberItem(stats.failures, 0));
+            table->setItem(row, 3, numberItem(stats.rows, 0));
+            table->setItem(row, 4, numberItem(stats.averageMs(), 3));
+            table->setItem(row, 5, numberItem(stats.percentileMs(0.50), 3));
+            table->setItem(row, 6, numberItem(stats.percentileMs(0.95), 3));
+            table->setItem(row, 7, numberItem(stats.maxNs / 1e6, 3));
+        }
+        table->setSortingEnabled(true);
+
+        // Cache de requêtes préparées, par connexion : l'écrivain du thread base de
+        // données (lu sur ce thread) puis chaque connexion de lecture du pool
+        AsyncDatabaseManager::instance().run([](DatabaseManager &db) {
+            return db.statementCacheStats();
+        }).then(cacheLabel, [cacheLabel](const DatabaseManager::StatementCacheStats &writerCache) {
+            auto describe = [](const QString &connection, const DatabaseManager::StatementCacheStats &cache) {
+                return QString("%1 : %2 hits, %3 misses, %4 requêtes préparées")
+                    .arg(connection).arg(cache.hits).arg(cache.misses).arg(cache.cachedStatements);
+            };
+
+            QStringList lines = {"Cache de requêtes par connexion :", describe("Thread base de données (écriture)", writerCache)};
+            const QMap<QString, DatabaseManager::StatementCacheStats> readers = ConnectionPool::instance().readerCacheStats();
+            for (auto it = readers.constBegin(); it != readers.constEnd(); ++it) {
+                lines << describe(it.key(), it.value());
+            }
+            cacheLabel->setText(lines.join("\n"));
+        });
+    };
+
+    connect(refreshButton, &QPushButton::clicked, dialog, refresh);
+    connect(resetButton, &QPushButton::clicked, dialog, [refresh]() {
+        QueryMetrics::instance().reset();
+        refresh();
+    });
+    connect(exportButton, &QPushButton::clicked, dialog, [dialog]() {
+        const QString filePath = DatabaseManager::dataDirectory() + "/query_metrics_"
+                                 + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".json";
+        if (QueryMetrics::instance().dumpToFile(filePath)) {
+            QMessageBox::information(dialog, "Export", "Métriques exportées vers :\n" + filePath);
+        } else {
+            QMessageBox::warning(dialog, "Export", "Impossible d'écrire " + filePath);
+        }
+    });
+
+    refresh();
+    dialog->show();
+}
+
 void DashboardWindow::animateStats() {
     QWidget* dataCardsSection = nullptr;
     for (int i = 0; i < exerciseView->layout()->count(); ++i) {
@@ -1035,13 +1199,16 @@ void DashboardWindow::saveUserStats()
         return;
     }
 
-    // Sauvegarder les statistiques
-    DatabaseManager::instance().updateUserStats(currentUser.userId, currentUser.workoutSessions,
-                                                currentUser.caloriesBurned, currentUser.activityMinutes,
-                                                currentUser.exercisesDone);
+    // Sauvegarder les statistiques (thread base de données : aucune attente côté GUI)
+    AsyncDatabaseManager::UserStats stats;
+    stats.workoutSessions = currentUser.workoutSessions;
+    stats.caloriesBurned = currentUser.caloriesBurned;
+    stats.activityMinutes = currentUser.activityMinutes;
+    stats.exercisesDone = currentUser.exercisesDone;
+    AsyncDatabaseManager::instance().updateUserStats(currentUser.userId, stats);
 
     // Sauvegarder les objectifs
-    DatabaseManager::instance().saveUserGoals(currentUser.userId, currentUser.goals);
+    AsyncDatabaseManager::instance().saveUserGoals(currentUser.userId, currentUser.goals);
 }
 
 void DashboardWindow::updateTimerDisplay() {
@@ -1134,11 +1301,11 @@ void DashboardWindow::updateStatisticsDisplay() {
                     QString newValue;
 
                     if (statName == "Séances d'entraînement") {
-                        newValue = QString("%1 cette semaine").arg(currentUser.workoutSessions);
+                        newValue = QString("%1 cette semaine").arg(weekRollup.sessions);
                     } else if (statName == "Calories brûlées") {
-                        newValue = QString("%1 kcal").arg(currentUser.caloriesBurned);
+                        newValue = QString("%1 kcal cette semaine").arg(weekRollup.calories);
                     } else if (statName == "Minutes d'activité") {
-                        newValue = QString("%1 min").arg(currentUser.activityMinutes);
+                        newValue = QString("%1 min cette semaine").arg(weekRollup.activeSeconds / 60);
                     }
 
                     if (!newValue.isEmpty()) {
@@ -1229,6 +1396,15 @@ void DashboardWindow::finishExercise() {
         showMaximized();
     });
 }
+namespace {
+// Statistiques et objectifs lus en une seule tâche sur le thread base de données
+struct UserDataResult
+{
+    DbResult<AsyncDatabaseManager::UserStats> stats;
+    DbResult<QMap<QString, int>> goals;
+};
+}
+
 void DashboardWindow::loadUserData()
 {
     // Si l'ID n'est pas valide (par ex. mode déconnecté), on ne fait rien.
@@ -1236,17 +1412,32 @@ void DashboardWindow::loadUserData()
         return;
     }
 
-    // Charger les statistiques et les objectifs depuis la base de données
-    DatabaseManager::instance().loadUserStats(currentUser.userId, currentUser.workoutSessions,
-                                              currentUser.caloriesBurned, currentUser.activityMinutes,
-                                              currentUser.exercisesDone);
-
-    DatabaseManager::instance().loadUserGoals(currentUser.userId, currentUser.goals);
-
     // S'assurer que les objectifs existent même si la DB est vide pour cet utilisateur
     if (currentUser.goals.isEmpty()) {
         currentUser.goals["Perte de poids"] = 0;
         currentUser.goals["Musculation"] = 0;
         // currentUser.goals["Cardio"] = 0;
     }
+
+    // Charger les statistiques et les objectifs depuis la base de données (asynchrone)
+    const int userId = currentUser.userId;
+    AsyncDatabaseManager::instance().run([userId](DatabaseManager &dbManager) {
+        UserDataResult result;
+        AsyncDatabaseManager::UserStats &stats = result.stats.value;
+        result.stats.ok = dbManager.loadUserStats(userId, stats.workoutSessions, stats.caloriesBurned,
+                                                  stats.activityMinutes, stats.exercisesDone);
+        result.goals.ok = dbManager.loadUserGoals(userId, result.goals.value);
+        return result;
+    }).then(this, [this](const UserDataResult &result) {
+        if (result.stats.ok) {
+            currentUser.workoutSessions = result.stats.value.workoutSessions;
+            currentUser.caloriesBurned = result.stats.value.caloriesBurned;
+            currentUser.activityMinutes = result.stats.value.activityMinutes;
+            currentUser.exercisesDone = result.stats.value.exercisesDone;
+        }
+        if (result.goals.ok && !result.goals.value.isEmpty()) {
+            currentUser.goals = result.goals.value;
+        }
+        updateStatisticsDisplay();
+    });
 }
@@ -19,19 +19,8 @@
 #include "mealplanview.h"
 #include "habitsview.h"
 #include "waterwidget.h"
-
-
-// Structure to store user information
-struct UserInfo {
-    QString name;
-    QString planType;
-    int workoutSessions;
-    int caloriesBurned;
-    int activityMinutes;
-    int exercisesDone;
-    int userId;
-    QMap<QString, int> goals;
-};
+#include "userinfo.h"
+#include "databasemanager.h"
 
 // Structure to store exercise information
 struct ExerciseInfo {
@@ -102,6 +91,10 @@ private:
 
     void saveUserStats();
     void animateStats();
+    // Historique : chaque série / séance est ajoutée au journal workout_events
+    void recordWorkoutEvent(DatabaseManager::WorkoutEventType type, int durationSeconds, int calories);
+    void loadWeeklyRollup();
+    void showDeveloperPanel(); // Métriques des requêtes (Ctrl+Maj+D)
     void displayExerciseWidgets();
     // Main UI components
     QWidget *centralWidget;
@@ -150,6 +143,9 @@ private:
 
     // User data
     UserInfo currentUser;
+    DatabaseManager::WorkoutRollup weekRollup; // Agrégat de la semaine en cours (cartes « cette semaine »)
+    DatabaseManager::WorkoutRollup weekRollupSinceLoad; // Événements enregistrés pendant le chargement de weekRollup
+    bool weekRollupLoading = false;
 
      QLabel *muscleMapLabel;
 };
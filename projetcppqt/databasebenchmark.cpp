@@ -0,0 +1,418 @@
+// Banc d'essai sans interface graphique de DatabaseManager.
+// Pour chaque volume de données, une base jetable est remplie en SQL brut puis
+// les opérations de l'application sont chronométrées via DatabaseManager.
+//
+// Les petites écritures (une transaction chacune) sont ensuite répétées sous chaque
+// profil de stockage pour en comparer le débit (écritures/s).
+//
+// Usage : azertyfit_dbbench [--sizes 1,100,10000,1000000] [--iterations 20]
+//                           [--profiles desktop,kiosk,benchmark]
+//                           [--output rapport.json] [--verbose]
+// Le rapport JSON est écrit sur la sortie standard si --output est absent.
+
+#include "databasemanager.h"
+#include "passwordhasher.h"
+#include "slowquerylog.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const int kBenchUserId = 1;
+const QString kBenchEmail = "user1@bench.local";
+const QString kBenchPassword = "benchmark";
+const int kHabitCount = 10;
+const qint64 kTimeBudgetMs = 5000; // Par opération et par volume
+const int kMinIterations = 3;
+const qint64 kThroughputMs = 2000; // Par opération, profil et volume
+
+bool verbose = false;
+
+void messageFilter(QtMsgType type, const QMessageLogContext &, const QString &message)
+{
+    // Les qDebug de DatabaseManager fausseraient les mesures et noieraient le rapport
+    if (type == QtDebugMsg && !verbose) {
+        return;
+    }
+    fprintf(stderr, "%s\n", qPrintable(message));
+}
+
+// Remplit la base en SQL brut, dans une seule transaction : rows utilisateurs,
+// rows repas (2 ingrédients chacun), rows complétions réparties sur kHabitCount
+// habitudes et rows jours de suivi d'hydratation, tous pour l'utilisateur 1.
+bool seedDatabase(const QString &databasePath, int rows)
+{
+    const QString connectionName = "efitness_bench_seed";
+    bool success = false;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(databasePath);
+        if (!database.open()) {
+            qWarning() << "Seed: ouverture impossible:" << database.lastError().text();
+            return false;
+        }
+
+        QSqlQuery query(database);
+        query.exec("PRAGMA synchronous = OFF");
+        database.transaction();
+
+        const QString passwordHash = PasswordHasher::hash(kBenchPassword);
+        success = query.prepare("INSERT INTO users (first_name, last_name, email, password, age, weight, height, fitness_level) "
+                                "VALUES ('Bench', ?, ?, ?, 30, 70.0, 175.0, 'Intermédiaire')");
+        for (int i = 1; success && i <= rows; ++i) {
+            query.bindValue(0, QString("User%1").arg(i));
+            query.bindValue(1, QString("user%1@bench.local").arg(i));
+            query.bindValue(2, passwordHash);
+            success = query.exec();
+        }
+
+        QSqlQuery ingredientQuery(database);
+        success = success && query.prepare("INSERT INTO meals (user_id, day_of_week, name, time, calories, image_path) "
+                                           "VALUES (?, ?, ?, ?, ?, '')")
+                  && ingredientQuery.prepare("INSERT INTO meal_ingredients (meal_id, ingredient_name, quantity) VALUES (?, ?, ?)");
+        for (int i = 0; success && i < rows; ++i) {
+            query.bindValue(0, kBenchUserId);
+            query.bindValue(1, i % 7);
+            query.bindValue(2, QString("Repas %1").arg(i));
+            query.bindValue(3, QTime(6, 0).addSecs((i % 960) * 60).toString("HH:mm"));
+            query.bindValue(4, 200 + i % 600);
+            success = query.exec();
+
+            const QVariant mealId = query.lastInsertId();
+            for (int j = 0; success && j < 2; ++j) {
+                ingredientQuery.bindValue(0, mealId);
+                ingredientQuery.bindValue(1, QString("Ingrédient %1").arg(j));
+                ingredientQuery.bindValue(2, QString("%1 g").arg(50 * (j + 1)));
+                success = ingredientQuery.exec();
+            }
+        }
+
+        success = success && query.prepare("INSERT INTO habits (user_id, habit_id, name, goal_days) VALUES (?, ?, ?, 30)");
+        for (int habitId = 1; success && habitId <= kHabitCount; ++habitId) {
+            query.bindValue(0, kBenchUserId);
+            query.bindValue(1, habitId);
+            query.bindValue(2, QString("Habitude %1").arg(habitId));
+            success = query.exec();
+        }
+
+        const QDate today = QDate::currentDate();
+        QMap<int, CompletionBitmap> completions;
+        for (int i = 0; i < rows; ++i) {
+            completions[i % kHabitCount + 1].insert(today.addDays(-(i / kHabitCount)));
+        }
+        // Résumés annuels écrits comme saveHabit. habit_year_summaries reste vide :
+        // loadHabits est mesuré sur tout l'historique, sans année archivée
+        success = success && query.prepare("INSERT INTO habit_completion_bitmaps (user_id, habit_id, year, bits, "
+                                           "completed_days, longest_run, leading_run, trailing_run) "
+                                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+        for (auto it = completions.constBegin(); success && it != completions.constEnd(); ++it) {
+            const QList<int> years = it.value().years();
+            for (int k = 0; success && k < years.size(); ++k) {
+                query.bindValue(0, kBenchUserId);
+                query.bindValue(1, it.key());
+                query.bindValue(2, years.at(k));
+                query.bindValue(3, it.value().yearBlob(years.at(k)));
+                const CompletionBitmap::YearSummary summary = it.value().summary(years.at(k));
+                query.bindValue(4, summary.completedDays);
+                query.bindValue(5, summary.longestRun);
+                query.bindValue(6, summary.leadingRun);
+                query.bindValue(7, summary.trailingRun);
+                success = query.exec();
+            }
+        }
+
+        success = success && query.prepare("INSERT INTO water_intake (user_id, date, daily_goal, current_amount) VALUES (?, ?, 2000, ?)");
+        for (int i = 0; success && i < rows; ++i) {
+            query.bindValue(0, kBenchUserId);
+            query.bindValue(1, today.addDays(-i).toString("yyyy-MM-dd"));
+            query.bindValue(2, (i * 250) % 2500);
+            success = query.exec();
+        }
+
+        if (!success) {
+            qWarning() << "Seed: échec:" << query.lastError().text() << ingredientQuery.lastError().text();
+            database.rollback();
+        } else {
+            success = database.commit();
+        }
+        query.finish();
+        ingredientQuery.finish();
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return success;
+}
+
+// Répète fn(i) jusqu'à iterations fois, ou moins si le budget de temps est
+// épuisé (au moins kMinIterations). Retourne un objet JSON de synthèse.
+template<typename Function>
+QJsonObject measure(const QString &operation, int rows, int iterations, Function fn)
+{
+    QList<double> timingsMs;
+    int failures = 0;
+    QElapsedTimer budget;
+    budget.start();
+
+    for (int i = 0; i < iterations; ++i) {
+        if (i >= kMinIterations && budget.elapsed() > kTimeBudgetMs) {
+            break;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        if (!fn(i)) {
+            failures++;
+        }
+        timingsMs.append(timer.nsecsElapsed() / 1e6);
+    }
+
+    std::sort(timingsMs.begin(), timingsMs.end());
+    double total = 0.0;
+    for (double value : timingsMs) {
+        total += value;
+    }
+    const auto rank = [&timingsMs](double percentile) {
+        const int index = qBound(0, int(std::ceil(percentile * timingsMs.size())) - 1, int(timingsMs.size()) - 1);
+        return timingsMs.at(index);
+    };
+
+    QJsonObject result;
+    result["operation"] = operation;
+    result["rows"] = rows;
+    result["iterations"] = int(timingsMs.size());
+    result["failures"] = failures;
+    result["min_ms"] = timingsMs.first();
+    result["median_ms"] = rank(0.50);
+    result["p95_ms"] = rank(0.95);
+    result["max_ms"] = timingsMs.last();
+    result["mean_ms"] = total / timingsMs.size();
+
+    fprintf(stderr, "  %-16s rows=%-8d n=%-3d median=%9.3f ms  p95=%9.3f ms%s\n",
+            qPrintable(operation), rows, int(timingsMs.size()), rank(0.50), rank(0.95),
+            failures ? qPrintable(QString("  (%1 échecs)").arg(failures)) : "");
+    return result;
+}
+
+// Répète fn(i) pendant kThroughputMs et rapporte le débit obtenu sous profile.
+// Chaque appel est une écriture validée isolément (pas de transaction englobante).
+template<typename Function>
+QJsonObject measureThroughput(const QString &operation, int rows,
+                              const DatabaseManager::StorageProfile &profile, Function fn)
+{
+    int writes = 0;
+    int failures = 0;
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < kThroughputMs) {
+        if (fn(writes + failures)) {
+            writes++;
+        } else {
+            failures++;
+        }
+    }
+    const double elapsedS = timer.nsecsElapsed() / 1e9;
+
+    QJsonObject result;
+    result["operation"] = operation;
+    result["rows"] = rows;
+    result["profile"] = profile.name;
+    result["journal_mode"] = profile.journalMode;
+    result["synchronous"] = profile.synchronous;
+    result["writes"] = writes;
+    result["failures"] = failures;
+    result["elapsed_ms"] = elapsedS * 1000.0;
+    result["writes_per_s"] = writes / elapsedS;
+
+    fprintf(stderr, "  %-16s rows=%-8d profil=%-9s %10.1f écritures/s%s\n",
+            qPrintable(operation), rows, qPrintable(profile.name), writes / elapsedS,
+            failures ? qPrintable(QString("  (%1 échecs)").arg(failures)) : "");
+    return result;
+}
+
+QJsonArray runSize(int rows, int iterations, const QList<DatabaseManager::StorageProfile> &profiles)
+{
+    QJsonArray results;
+
+    QTemporaryDir dataDir;
+    if (!dataDir.isValid()) {
+        qWarning() << "Dossier temporaire indisponible";
+        return results;
+    }
+    qputenv("EFITNESS_DATA_DIR", dataDir.path().toUtf8());
+
+    DatabaseManager manager("efitness_bench");
+    if (!manager.openDatabase()) {
+        qWarning() << "Ouverture de la base impossible pour" << rows << "lignes";
+        return results;
+    }
+
+    fprintf(stderr, "Volume %d : remplissage...\n", rows);
+    QElapsedTimer seedTimer;
+    seedTimer.start();
+    if (!seedDatabase(manager.databasePath(), rows)) {
+        return results;
+    }
+    fprintf(stderr, "  remplissage en %.1f s\n", seedTimer.elapsed() / 1000.0);
+
+    results.append(measure("createUser", rows, iterations, [&](int i) {
+        return manager.createUser("Bench", "New", QString("new%1_%2@bench.local").arg(rows).arg(i),
+                                  kBenchPassword, 30, 70.0, 175.0, "Débutant");
+    }));
+    results.append(measure("checkCredentials", rows, iterations, [&](int) {
+        return manager.checkCredentials(kBenchEmail, kBenchPassword);
+    }));
+
+    results.append(measure("loadMeals", rows, iterations, [&](int) {
+        QMap<int, QList<MealPlanView::MealInfo>> meals;
+        return manager.loadMeals(kBenchUserId, meals);
+    }));
+    MealPlanView::MealInfo meal;
+    meal.name = "Repas bench";
+    meal.time = "12:00";
+    meal.ingredients = {{"Riz", "150 g"}, {"Poulet", "120 g"}};
+    meal.proteinGrams = 35;
+    meal.carbsGrams = 60;
+    meal.fatGrams = 15;
+    results.append(measure("saveMeal", rows, iterations, [&](int i) {
+        meal.calories = 500 + i;
+        return manager.saveMeal(kBenchUserId, 0, meal);
+    }));
+
+    // N complétions réparties sur kHabitCount habitudes : jusqu'à 100 000 dates par habitude à 1M lignes
+    QMap<int, Habit> habits;
+    results.append(measure("loadHabits", rows, iterations, [&](int) {
+        return manager.loadHabits(kBenchUserId, habits);
+    }));
+    // Réécriture complète de l'habitude 1 avec tout son historique (rows / kHabitCount dates)
+    const CompletionBitmap completedDates = habits.value(1).completedDates;
+    results.append(measure("saveHabit", rows, iterations, [&](int) {
+        return manager.saveHabit(kBenchUserId, 1, "Habitude 1", 30, completedDates);
+    }));
+
+    const QString today = QDate::currentDate().toString("yyyy-MM-dd");
+    results.append(measure("loadWaterData", rows, iterations, [&](int) {
+        int dailyGoal = 0;
+        int currentAmount = 0;
+        return manager.loadWaterData(kBenchUserId, today, dailyGoal, currentAmount);
+    }));
+    results.append(measure("saveWaterData", rows, iterations, [&](int i) {
+        return manager.saveWaterData(kBenchUserId, today, 2000, (i * 250) % 2500);
+    }));
+
+    // Débit des petites écritures de l'interface (hydratation, case d'habitude) par profil,
+    // appliqué à chaud sur la même base : seul le réglage PRAGMA change entre les mesures
+    const QDate todayDate = QDate::currentDate();
+    for (const DatabaseManager::StorageProfile &profile : profiles) {
+        manager.setStorageProfile(profile);
+        results.append(measureThroughput("saveWaterData", rows, profile, [&](int i) {
+            return manager.saveWaterData(kBenchUserId, today, 2000, (i * 250) % 2500);
+        }));
+        results.append(measureThroughput("addHabitCompletion", rows, profile, [&](int i) {
+            return manager.addHabitCompletion(kBenchUserId, 2, todayDate.addDays(-(i % 3650)));
+        }));
+    }
+
+    manager.closeDatabase();
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Les données sont injectées directement dans fitness_data.db
+    qputenv("EFITNESS_STORAGE_LAYOUT", "single");
+    QCoreApplication::setApplicationName("azertyfit_dbbench");
+    qInstallMessageHandler(messageFilter);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Banc d'essai de DatabaseManager (rapport JSON)");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes", "Volumes de données, séparés par des virgules.", "liste", "1,100,10000,1000000");
+    QCommandLineOption iterationsOption("iterations", "Répétitions maximales par opération.", "n", "20");
+    QCommandLineOption profilesOption("profiles", "Profils de stockage comparés en débit d'écriture.", "liste",
+                                      "desktop,kiosk,benchmark");
+    QCommandLineOption outputOption("output", "Fichier du rapport JSON (sortie standard par défaut).", "fichier");
+    QCommandLineOption verboseOption("verbose", "Affiche les messages de debug de DatabaseManager.");
+    parser.addOptions({sizesOption, iterationsOption, profilesOption, outputOption, verboseOption});
+    parser.process(app);
+
+    verbose = parser.isSet(verboseOption);
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    QList<int> sizes;
+    for (const QString &size : parser.value(sizesOption).split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const int rows = size.trimmed().toInt(&ok);
+        if (!ok || rows < 1) {
+            qWarning() << "Volume invalide:" << size;
+            return 2;
+        }
+        sizes.append(rows);
+    }
+    QList<DatabaseManager::StorageProfile> profiles;
+    for (const QString &name : parser.value(profilesOption).split(',', Qt::SkipEmptyParts)) {
+        const QString key = name.trimmed().toLower();
+        if (key == "desktop") {
+            profiles.append(DatabaseManager::StorageProfile::desktop());
+        } else if (key == "kiosk") {
+            profiles.append(DatabaseManager::StorageProfile::kiosk());
+        } else if (key == "benchmark") {
+            profiles.append(DatabaseManager::StorageProfile::benchmark());
+        } else {
+            qWarning() << "Profil invalide:" << name;
+            return 2;
+        }
+    }
+
+    // Le journal des requêtes lentes écrirait dans le dossier temporaire de chaque volume
+    SlowQueryLog::instance().setThresholdMs(-1);
+
+    QJsonArray results;
+    for (int rows : sizes) {
+        const QJsonArray sizeResults = runSize(rows, iterations, profiles);
+        if (sizeResults.isEmpty()) {
+            return 1;
+        }
+        for (const QJsonValue &result : sizeResults) {
+            results.append(result);
+        }
+    }
+
+    QJsonObject report;
+    report["generated_at"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    report["qt_version"] = QString(qVersion());
+    report["storage_profile"] = DatabaseManager::StorageProfile::fromName(qEnvironmentVariable("EFITNESS_STORAGE_PROFILE")).name;
+    report["password_iterations"] = PasswordHasher::iterations();
+    report["max_iterations"] = iterations;
+    report["results"] = results;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QSaveFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Impossible d'écrire" << parser.value(outputOption);
+            return 1;
+        }
+        file.write(json);
+        if (!file.commit()) {
+            return 1;
+        }
+    } else {
+        fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    }
+    return 0;
+}
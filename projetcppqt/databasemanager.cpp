@@ -1,29 +1,88 @@
 #include "databasemanager.h"
+#include "passwordhasher.h"
+#include "querymetrics.h"
+#include "slowquerylog.h"
 #include <QDir>
 #include <QStandardPaths>
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QMessageBox>
 #include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <atomic>
+
+namespace {
+// Utilisateur connecté, partagé par toutes les connexions (worker asynchrone,
+// pool) : en disposition Sharded, son fichier est attaché avant toute transaction.
+std::atomic<int> activeShardUserId{-1};
+}
 
-DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent), m_isInitialized(false)
+DatabaseManager::DatabaseManager(const QString &connectionName, OpenMode mode, QObject *parent)
+    : QObject(parent), m_connectionName(connectionName), m_openMode(mode), m_isInitialized(false),
+      m_currentLoggedInUserId(-1), m_transactionDepth(0), m_transactionFailed(false),
+      m_attachedUserId(-1)
 {
-    // Créer le dossier de données s'il n'existe pas
-    QDir dataDir(QDir::homePath() + "/.efitness");
-    if (!dataDir.exists()) {
-        dataDir.mkpath(".");
+    if (storageLayout() == StorageLayout::Sharded) {
+        m_schemaRole = SchemaRole::Directory;
+        m_databasePath = dataDirectory() + "/directory.db";
+    } else {
+        m_schemaRole = SchemaRole::Full;
+        m_databasePath = dataDirectory() + "/fitness_data.db";
     }
 
-    m_databasePath = dataDir.absolutePath() + "/fitness_data.db";
-
     // Configurer la connexion à la base de données
-    m_database = QSqlDatabase::addDatabase("QSQLITE");
+    m_database = m_connectionName.isEmpty() ? QSqlDatabase::addDatabase("QSQLITE")
+                                            : QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
     m_database.setDatabaseName(m_databasePath);
+    if (m_openMode == ReadOnly) {
+        m_database.setConnectOptions("QSQLITE_OPEN_READONLY");
+    }
+
+    m_storageProfile = StorageProfile::fromName(qEnvironmentVariable("EFITNESS_STORAGE_PROFILE"));
 }
 
 DatabaseManager::~DatabaseManager()
 {
     closeDatabase();
+
+    // Une connexion nommée est retirée du registre Qt une fois le handle libéré
+    if (!m_connectionName.isEmpty()) {
+        m_database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+}
+
+QString DatabaseManager::dataDirectory()
+{
+    // EFITNESS_DATA_DIR permet d'isoler une base jetable (banc d'essai, démonstration)
+    const QString overridePath = qEnvironmentVariable("EFITNESS_DATA_DIR");
+    QDir dataDir(overridePath.isEmpty() ? QDir::homePath() + "/.efitness" : overridePath);
+
+    // Créer le dossier de données s'il n'existe pas
+    if (!dataDir.exists()) {
+        dataDir.mkpath(".");
+    }
+    return dataDir.absolutePath();
+}
+
+DatabaseManager::StorageLayout DatabaseManager::storageLayout()
+{
+    static const StorageLayout layout =
+        qEnvironmentVariable("EFITNESS_STORAGE_LAYOUT").trimmed().compare("sharded", Qt::CaseInsensitive) == 0
+            ? StorageLayout::Sharded : StorageLayout::SingleFile;
+    return layout;
+}
+
+QString DatabaseManager::userShardPath(int userId)
+{
+    QDir shardDir(dataDirectory() + "/users");
+    if (!shardDir.exists()) {
+        shardDir.mkpath(".");
+    }
+    return shardDir.absoluteFilePath(QString("user_%1.db").arg(userId));
 }
 
 DatabaseManager& DatabaseManager::instance()
@@ -40,23 +99,141 @@ bool DatabaseManager::openDatabase()
             qDebug() << "Erreur lors de l'ouverture de la base de données:" << m_database.lastError().text();
             return false;
         }
+
+        if (!applyStorageProfile()) {
+            qDebug() << "Avertissement : profil de stockage" << m_storageProfile.name << "non appliqué entièrement";
+        }
+    }
+
+    // Une connexion en lecture seule ne peut pas créer le schéma : il l'a été par un écrivain
+    if (m_openMode == ReadOnly) {
+        m_isInitialized = true;
     }
 
     // Créer les tables si elles n'existent pas
-    if (!m_isInitialized) {
-        if (createTables()) {
-            m_isInitialized = true;
-        } else {
+    if (!m_isInitialized && m_schemaRole == SchemaRole::Directory) {
+        // Annuaire : profils uniquement. Les autres tables et les migrations
+        // vivent dans les fichiers utilisateur (initializeUserShard).
+        if (!createDirectoryTables()) {
+            qDebug() << "Erreur lors de la création de l'annuaire";
+            return false;
+        }
+    } else if (!m_isInitialized) {
+        if (!createTables()) {
             qDebug() << "Erreur lors de la création des tables";
             return false;
         }
+        if (!migrateSchema()) {
+            qDebug() << "Erreur lors de la migration du schéma";
+            return false;
+        }
+        m_isInitialized = true;
+        // Le schéma a pu changer : les requêtes préparées en cache sont invalidées
+        clearStatementCache();
     }
 
     return true;
 }
 
+bool DatabaseManager::openForUser(int userId)
+{
+    if (!isOpen() && !openDatabase()) {
+        return false;
+    }
+    return attachUserShard(userId);
+}
+
+bool DatabaseManager::attachUserShard(int userId)
+{
+    if (m_schemaRole != SchemaRole::Directory || m_attachedUserId == userId) {
+        return true;
+    }
+    if (m_transactionDepth > 0) {
+        qDebug() << "Impossible d'attacher le fichier de l'utilisateur" << userId << "pendant une transaction";
+        return false;
+    }
+
+    // DETACH échoue tant qu'une requête préparée référence le fichier
+    clearStatementCache();
+    QSqlQuery query(m_database);
+    if (m_attachedUserId != -1) {
+        if (!query.exec("DETACH DATABASE shard")) {
+            qDebug() << "Error detaching user shard:" << query.lastError().text();
+            return false;
+        }
+        m_attachedUserId = -1;
+    }
+
+    // Une connexion en lecture seule ne crée rien : le fichier doit déjà exister
+    if (m_openMode == ReadWrite && !initializeUserShard(userId)) {
+        return false;
+    }
+
+    // Les tables non qualifiées sont cherchées dans main puis dans shard : l'annuaire
+    // ne contenant que users et user_goals, les autres tables viennent du fichier utilisateur
+    query.prepare("ATTACH DATABASE :path AS shard");
+    query.bindValue(":path", userShardPath(userId));
+    if (!query.exec()) {
+        qDebug() << "Error attaching user shard:" << query.lastError().text();
+        return false;
+    }
+    m_attachedUserId = userId;
+    return true;
+}
+
+bool DatabaseManager::initializeUserShard(int userId)
+{
+    // Une seule initialisation par fichier et par processus, quel que soit le thread
+    static QMutex mutex;
+    static QSet<int> initializedUsers;
+    QMutexLocker locker(&mutex);
+    if (initializedUsers.contains(userId)) {
+        return true;
+    }
+
+    // Le fichier utilisateur reçoit le schéma complet et les migrations par une
+    // connexion dédiée ; ses tables users et user_goals restent vides (masquées par l'annuaire)
+    bool success = false;
+    {
+        DatabaseManager shard(QString("efitness_shard_init_%1").arg(userId));
+        shard.m_schemaRole = SchemaRole::Full;
+        shard.m_databasePath = userShardPath(userId);
+        shard.m_database.setDatabaseName(shard.m_databasePath);
+        success = shard.openDatabase();
+    }
+    if (success) {
+        initializedUsers.insert(userId);
+    } else {
+        qDebug() << "Erreur lors de l'initialisation du fichier de l'utilisateur" << userId;
+    }
+    return success;
+}
+
+void DatabaseManager::setCurrentUserId(int userId)
+{
+    m_currentLoggedInUserId = userId;
+    setActiveShardUser(userId);
+    if (m_schemaRole == SchemaRole::Directory && isOpen()) {
+        attachUserShard(userId);
+    }
+}
+
+void DatabaseManager::setActiveShardUser(int userId)
+{
+    activeShardUserId.store(userId);
+}
+
+int DatabaseManager::getCurrentUserId() const
+{
+    return m_currentLoggedInUserId;
+}
+
 void DatabaseManager::closeDatabase()
 {
+    // Les requêtes préparées appartiennent à la connexion : on les libère avant la fermeture
+    clearStatementCache();
+    m_attachedUserId = -1; // La fermeture détache aussi le fichier utilisateur
+
     if (m_database.isOpen()) {
         m_database.close();
     }
@@ -67,60 +244,314 @@ bool DatabaseManager::isOpen() const
     return m_database.isOpen();
 }
 
+// Poste personnel : WAL + synchronous NORMAL (pas de fsync à chaque commit,
+// seulement aux checkpoints), cache et mmap généreux.
+DatabaseManager::StorageProfile DatabaseManager::StorageProfile::desktop()
+{
+    StorageProfile profile;
+    profile.name = "desktop";
+    profile.journalMode = "WAL";
+    profile.synchronous = "NORMAL";
+    profile.cacheSizeKiB = 16384;
+    profile.mmapSizeBytes = 64LL * 1024 * 1024;
+    profile.busyTimeoutMs = 5000;
+    return profile;
+}
+
+// Borne partagée : durabilité maximale, mémoire réduite et attente plus
+// longue sur les verrous car plusieurs sessions peuvent écrire en même temps.
+DatabaseManager::StorageProfile DatabaseManager::StorageProfile::kiosk()
+{
+    StorageProfile profile;
+    profile.name = "kiosk";
+    profile.journalMode = "WAL";
+    profile.synchronous = "FULL";
+    profile.cacheSizeKiB = 2048;
+    profile.mmapSizeBytes = 0;
+    profile.busyTimeoutMs = 15000;
+    return profile;
+}
+
+// Mesures de débit uniquement : aucune garantie de durabilité.
+DatabaseManager::StorageProfile DatabaseManager::StorageProfile::benchmark()
+{
+    StorageProfile profile;
+    profile.name = "benchmark";
+    profile.journalMode = "WAL";
+    profile.synchronous = "OFF";
+    profile.cacheSizeKiB = 65536;
+    profile.mmapSizeBytes = 256LL * 1024 * 1024;
+    profile.busyTimeoutMs = 1000;
+    return profile;
+}
+
+DatabaseManager::StorageProfile DatabaseManager::StorageProfile::fromName(const QString &name)
+{
+    const QString key = name.trimmed().toLower();
+    if (key == "kiosk" || key == "shared") {
+        return kiosk();
+    }
+    if (key == "benchmark") {
+        return benchmark();
+    }
+    if (!key.isEmpty() && key != "desktop") {
+        qDebug() << "Profil de stockage inconnu:" << name << "- utilisation de \"desktop\"";
+    }
+    return desktop();
+}
+
+void DatabaseManager::setStorageProfile(const StorageProfile &profile)
+{
+    m_storageProfile = profile;
+    if (isOpen()) {
+        applyStorageProfile();
+    }
+}
+
+bool DatabaseManager::applyStorageProfile()
+{
+    QSqlQuery query(m_database);
+    bool success = true;
+
+    // journal_mode renvoie le mode effectif (WAL peut être refusé, ex. système de fichiers réseau).
+    // Il est persistant dans le fichier : une connexion en lecture seule hérite du mode de l'écrivain.
+    if (m_openMode == ReadWrite) {
+        if (query.exec(QString("PRAGMA journal_mode = %1").arg(m_storageProfile.journalMode)) && query.next()) {
+            const QString effectiveMode = query.value(0).toString();
+            if (effectiveMode.compare(m_storageProfile.journalMode, Qt::CaseInsensitive) != 0) {
+                qDebug() << "journal_mode demandé:" << m_storageProfile.journalMode << "obtenu:" << effectiveMode;
+                success = false;
+            }
+        } else {
+            qDebug() << "Error setting journal_mode:" << query.lastError().text();
+            success = false;
+        }
+    }
+
+    const QStringList pragmas = {
+        QString("PRAGMA synchronous = %1").arg(m_storageProfile.synchronous),
+        // Valeur négative : taille exprimée en KiB plutôt qu'en nombre de pages
+        QString("PRAGMA cache_size = -%1").arg(m_storageProfile.cacheSizeKiB),
+        QString("PRAGMA mmap_size = %1").arg(m_storageProfile.mmapSizeBytes),
+        QString("PRAGMA busy_timeout = %1").arg(m_storageProfile.busyTimeoutMs)
+    };
+    for (const QString &pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qDebug() << "Error applying" << pragma << ":" << query.lastError().text();
+            success = false;
+        }
+    }
+    query.finish();
+
+    qDebug() << "Profil de stockage appliqué:" << m_storageProfile.name;
+    return success;
+}
+
+DatabaseManager::CachedQuery DatabaseManager::cachedQuery(const QString &sql)
+{
+    auto it = m_statementCache.constFind(sql);
+    if (it != m_statementCache.constEnd()) {
+        m_statementCacheStats.hits++;
+        return CachedQuery(it.value());
+    }
+
+    m_statementCacheStats.misses++;
+    QSharedPointer<QSqlQuery> query(new QSqlQuery(m_database));
+    query->setForwardOnly(true);
+    if (query->prepare(sql)) {
+        m_statementCache.insert(sql, query);
+    } else {
+        // Pas de mise en cache : l'erreur sera remontée par exec()
+        qDebug() << "Erreur lors de la préparation de la requête:" << query->lastError().text();
+    }
+    return CachedQuery(query);
+}
+
+bool DatabaseManager::exec(QSqlQuery &query)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const bool success = query.exec();
+    SlowQueryLog::instance().check(m_database, query, timer.nsecsElapsed());
+    return success;
+}
+
+bool DatabaseManager::exec(QSqlQuery &query, const QString &sql)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const bool success = query.exec(sql);
+    SlowQueryLog::instance().check(m_database, query, timer.nsecsElapsed());
+    return success;
+}
+
+void DatabaseManager::clearStatementCache()
+{
+    m_statementCache.clear();
+}
+
+DatabaseManager::StatementCacheStats DatabaseManager::statementCacheStats() const
+{
+    StatementCacheStats stats = m_statementCacheStats;
+    stats.cachedStatements = m_statementCache.size();
+    return stats;
+}
+
+void DatabaseManager::resetStatementCacheStats()
+{
+    m_statementCacheStats = StatementCacheStats();
+}
+
+bool DatabaseManager::beginTransaction()
+{
+    if (!isOpen() && !openDatabase()) {
+        return false;
+    }
+
+    if (m_transactionDepth == 0) {
+        // ATTACH est interdit dans une transaction : le fichier de l'utilisateur
+        // connecté est attaché avant le BEGIN
+        const int activeUserId = activeShardUserId.load();
+        if (m_schemaRole == SchemaRole::Directory && activeUserId >= 0 && !attachUserShard(activeUserId)) {
+            return false;
+        }
+        if (!m_database.transaction()) {
+            qDebug() << "Erreur lors du démarrage de la transaction:" << m_database.lastError().text();
+            return false;
+        }
+        m_transactionFailed = false;
+    }
+    m_transactionDepth++;
+    return true;
+}
+
+bool DatabaseManager::commitTransaction()
+{
+    if (m_transactionDepth == 0) {
+        return false;
+    }
+
+    m_transactionDepth--;
+    if (m_transactionDepth > 0) {
+        // Transaction interne : le COMMIT réel est fait par la plus externe
+        return !m_transactionFailed;
+    }
+
+    if (m_transactionFailed) {
+        m_database.rollback();
+        m_transactionFailed = false;
+        return false;
+    }
+
+    if (!m_database.commit()) {
+        qDebug() << "Erreur lors du commit de la transaction:" << m_database.lastError().text();
+        m_database.rollback();
+        return false;
+    }
+    return true;
+}
+
+void DatabaseManager::rollbackTransaction()
+{
+    if (m_transactionDepth == 0) {
+        return;
+    }
+
+    m_transactionDepth--;
+    m_transactionFailed = true;
+    if (m_transactionDepth == 0) {
+        m_database.rollback();
+        m_transactionFailed = false;
+    }
+}
+
+DatabaseManager::Transaction::Transaction(DatabaseManager &manager)
+    : m_manager(manager), m_active(manager.beginTransaction())
+{
+}
+
+DatabaseManager::Transaction::~Transaction()
+{
+    if (m_active) {
+        m_manager.rollbackTransaction();
+    }
+}
+
+bool DatabaseManager::Transaction::commit()
+{
+    if (!m_active) {
+        return false;
+    }
+    m_active = false;
+    return m_manager.commitTransaction();
+}
+
 
 bool DatabaseManager::createUser(const QString &firstName, const QString &lastName,
                                  const QString &email, const QString &password,
                                  int age, double weight, double height,
                                  const QString &fitnessLevel)
 {
+    if (password.length() < 6) {
+        qDebug() << "Erreur: Mot de passe trop court";
+        return false;
+    }
+
+    // Hasher le mot de passe (PBKDF2 salé, coût calibré au démarrage)
+    return createUserWithHash(firstName, lastName, email, PasswordHasher::hash(password),
+                              age, weight, height, fitnessLevel);
+}
+
+bool DatabaseManager::createUserWithHash(const QString &firstName, const QString &lastName,
+                                         const QString &email, const QString &passwordHash,
+                                         int age, double weight, double height,
+                                         const QString &fitnessLevel)
+{
+    QueryTimer timer("createUser");
     if (!isOpen() && !openDatabase()) {
         qDebug() << "Erreur: Impossible d'ouvrir la base de données";
+        timer.fail();
         return false;
     }
 
     // Validation des données d'entrée
-    if (firstName.trimmed().isEmpty() || lastName.trimmed().isEmpty() || email.trimmed().isEmpty()) {
+    if (firstName.trimmed().isEmpty() || lastName.trimmed().isEmpty() || email.trimmed().isEmpty()
+        || passwordHash.isEmpty()) {
         qDebug() << "Erreur: Champs obligatoires manquants";
-        return false;
-    }
-
-    if (password.length() < 6) {
-        qDebug() << "Erreur: Mot de passe trop court";
+        timer.fail();
         return false;
     }
 
     // Vérifier si l'email existe déjà
-    QSqlQuery checkQuery;
-    checkQuery.prepare("SELECT COUNT(*) FROM users WHERE email = ?");
-    checkQuery.addBindValue(email.trimmed());
+    CachedQuery checkQuery = cachedQuery("SELECT COUNT(*) FROM users WHERE email = ?");
+    checkQuery->bindValue(0, email.trimmed());
 
-    if (!checkQuery.exec()) {
-        qDebug() << "Erreur lors de la vérification de l'email:" << checkQuery.lastError().text();
+    if (!exec(*checkQuery)) {
+        qDebug() << "Erreur lors de la vérification de l'email:" << checkQuery->lastError().text();
+        timer.fail();
         return false;
     }
 
-    if (checkQuery.next() && checkQuery.value(0).toInt() > 0) {
+    if (checkQuery->next() && checkQuery->value(0).toInt() > 0) {
         qDebug() << "Erreur: Email déjà utilisé:" << email;
+        timer.fail();
         return false;
     }
+    checkQuery->finish();
 
     // Préparer la requête d'insertion
-    QSqlQuery query;
-    query.prepare("INSERT INTO users (first_name, last_name, email, password, age, weight, height, fitness_level) "
-                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
-
-    // Hasher le mot de passe
-    QString hashedPassword = QString(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex());
+    CachedQuery query = cachedQuery("INSERT INTO users (first_name, last_name, email, password, age, weight, height, fitness_level) "
+                                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
 
     // Lier les valeurs
-    query.addBindValue(firstName.trimmed());
-    query.addBindValue(lastName.trimmed());
-    query.addBindValue(email.trimmed());
-    query.addBindValue(hashedPassword);
-    query.addBindValue(age);
-    query.addBindValue(weight);
-    query.addBindValue(height);
-    query.addBindValue(fitnessLevel);
+    query->bindValue(0, firstName.trimmed());
+    query->bindValue(1, lastName.trimmed());
+    query->bindValue(2, email.trimmed());
+    query->bindValue(3, passwordHash);
+    query->bindValue(4, age);
+    query->bindValue(5, weight);
+    query->bindValue(6, height);
+    query->bindValue(7, fitnessLevel);
 
     // Debug des valeurs
     qDebug() << "Creating user with values:";
@@ -133,18 +564,21 @@ bool DatabaseManager::createUser(const QString &firstName, const QString &lastNa
     qDebug() << "Fitness Level:" << fitnessLevel;
 
     // Exécuter la requête
-    if (!query.exec()) {
-        qDebug() << "Erreur lors de la création de l'utilisateur:" << query.lastError().text();
-        qDebug() << "Query SQL:" << query.lastQuery();
-        qDebug() << "Database error:" << query.lastError().databaseText();
-        qDebug() << "Driver error:" << query.lastError().driverText();
+    if (!exec(*query)) {
+        qDebug() << "Erreur lors de la création de l'utilisateur:" << query->lastError().text();
+        qDebug() << "Query SQL:" << query->lastQuery();
+        qDebug() << "Database error:" << query->lastError().databaseText();
+        qDebug() << "Driver error:" << query->lastError().driverText();
+        timer.fail();
         return false;
     }
+    timer.addRows(query->numRowsAffected());
 
     // Récupérer l'ID du nouvel utilisateur
     int userId = getUserId(email.trimmed());
     if (userId == -1) {
         qDebug() << "Erreur: Impossible de récupérer l'ID utilisateur après création";
+        timer.fail();
         return false;
     }
 
@@ -166,46 +600,75 @@ bool DatabaseManager::createUser(const QString &firstName, const QString &lastNa
 
 bool DatabaseManager::checkCredentials(const QString &email, const QString &password)
 {
+    QueryTimer timer("checkCredentials");
     // Vérifier si la connexion à la base de données est ouverte
     if (!isOpen()) {
         if (!openDatabase()) {
+            timer.fail();
             return false;
         }
     }
 
-    QSqlQuery query;
+    CachedQuery query = cachedQuery("SELECT id, password FROM users WHERE email = ?");
+    query->bindValue(0, email);
 
-    // Hasher le mot de passe pour la vérification
-    QString hashedPassword = QString(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex());
+    if (!exec(*query) || !query->next()) {
+        return false; // Utilisateur introuvable
+    }
+    const int userId = query->value(0).toInt();
+    const QString storedHash = query->value(1).toString();
+    query->finish();
 
-    // Préparer la requête de vérification
-    query.prepare("SELECT id FROM users WHERE email = ? AND password = ?");
-    query.addBindValue(email);
-    query.addBindValue(hashedPassword);
+    bool needsRehash = false;
+    if (!PasswordHasher::verify(password, storedHash, &needsRehash)) {
+        return false;
+    }
 
-    // Exécuter la requête
-    if (query.exec() && query.next()) {
-        return true; // Utilisateur trouvé
+    // Migration transparente des anciens hachages SHA-256 après une connexion réussie
+    if (needsRehash) {
+        updatePasswordHash(userId, PasswordHasher::hash(password));
     }
+    return true;
+}
 
-    return false;
+bool DatabaseManager::updatePasswordHash(int userId, const QString &passwordHash)
+{
+    QueryTimer timer("updatePasswordHash");
+    if (!isOpen() && !openDatabase()) {
+        timer.fail();
+        return false;
+    }
+
+    CachedQuery query = cachedQuery("UPDATE users SET password = :password WHERE id = :id");
+    query->bindValue(":password", passwordHash);
+    query->bindValue(":id", userId);
+
+    if (!exec(*query)) {
+        qDebug() << "Error updating password hash:" << query->lastError().text();
+        timer.fail();
+        return false;
+    }
+    timer.addRows(query->numRowsAffected());
+    return true;
 }
 
 int DatabaseManager::getUserId(const QString &email)
 {
+    QueryTimer timer("getUserId");
     // Vérifier si la connexion à la base de données est ouverte
     if (!isOpen()) {
         if (!openDatabase()) {
+            timer.fail();
             return -1;
         }
     }
 
-    QSqlQuery query;
-    query.prepare("SELECT id FROM users WHERE email = ?");
-    query.addBindValue(email);
+    CachedQuery query = cachedQuery("SELECT id FROM users WHERE email = ?");
+    query->bindValue(0, email);
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+    if (exec(*query) && query->next()) {
+        timer.addRows(1);
+        return query->value(0).toInt();
     }
 
     return -1; // Utilisateur non trouvé
@@ -213,38 +676,94 @@ int DatabaseManager::getUserId(const QString &email)
 bool DatabaseManager::getUserInfo(const QString &email, QString &firstName, QString &lastName,
                                   int &age, double &weight, double &height, QString &fitnessLevel)
 {
+    QueryTimer timer("getUserInfo");
     // Vérifier si la connexion à la base de données est ouverte
     if (!isOpen()) {
         if (!openDatabase()) {
+            timer.fail();
             return false;
         }
     }
 
-    QSqlQuery query;
-    query.prepare("SELECT first_name, last_name, age, weight, height, fitness_level FROM users WHERE email = ?");
-    query.addBindValue(email);
+    CachedQuery query = cachedQuery("SELECT first_name, last_name, age, weight, height, fitness_level FROM users WHERE email = ?");
+    query->bindValue(0, email);
 
-    if (query.exec() && query.next()) {
-        firstName = query.value(0).toString();
-        lastName = query.value(1).toString();
-        age = query.value(2).toInt();
-        weight = query.value(3).toDouble();
-        height = query.value(4).toDouble();
-        fitnessLevel = query.value(5).toString();
+    if (exec(*query) && query->next()) {
+        timer.addRows(1);
+        firstName = query->value(0).toString();
+        lastName = query->value(1).toString();
+        age = query->value(2).toInt();
+        weight = query->value(3).toDouble();
+        height = query->value(4).toDouble();
+        fitnessLevel = query->value(5).toString();
         return true;
     }
 
     return false; // Utilisateur non trouvé
 }
 
+bool DatabaseManager::loadSession(const QString &email, UserInfo &userInfo, QString &passwordHash)
+{
+    QueryTimer timer("loadSession");
+    if (!isOpen() && !openDatabase()) {
+        timer.fail();
+        return false;
+    }
+
+    // Une ligne par objectif (ou une seule ligne sans objectif grâce au LEFT JOIN) :
+    // hachage, profil, statistiques et objectifs en un seul aller-retour
+    CachedQuery query = cachedQuery("SELECT u.id, u.first_name, u.last_name, u.plan_type, "
+                                    "u.workout_sessions, u.calories_burned, u.activity_minutes, u.exercises_done, "
+                                    "u.password, g.goal_name, g.progress "
+                                    "FROM users u LEFT JOIN user_goals g ON g.user_id = u.id "
+                                    "WHERE u.email = ?");
+    query->bindValue(0, email);
+
+    if (!exec(*query)) {
+        qDebug() << "Error loading session:" << query->lastError().text();
+        timer.fail();
+        return false;
+    }
+    if (!query->next()) {
+        return false; // Email inconnu
+    }
+
+    userInfo = UserInfo();
+    userInfo.userId = query->value(0).toInt();
+    userInfo.name = query->value(1).toString() + " " + query->value(2).toString();
+    if (!query->isNull(3)) {
+        userInfo.planType = query->value(3).toString();
+    }
+    userInfo.workoutSessions = query->value(4).toInt();
+    userInfo.caloriesBurned = query->value(5).toInt();
+    userInfo.activityMinutes = query->value(6).toInt();
+    userInfo.exercisesDone = query->value(7).toInt();
+    passwordHash = query->value(8).toString();
+
+    do {
+        timer.addRows(1);
+        if (!query->isNull(9)) {
+            userInfo.goals[query->value(9).toString()] = query->value(10).toInt();
+        }
+    } while (query->next());
+
+    return true;
+}
+
 QString DatabaseManager::getUserName(int userId) {
-    QSqlQuery query;
-    query.prepare("SELECT first_name, last_name FROM users WHERE id = :id");
-    query.bindValue(":id", userId);
+    QueryTimer timer("getUserName");
+    if (!isOpen() && !openDatabase()) {
+        timer.fail();
+        return "Utilisateur";
+    }
+
+    CachedQuery query = cachedQuery("SELECT first_name, last_name FROM users WHERE id = :id");
+    query->bindValue(":id", userId);
 
-    if (query.exec() && query.next()) {
-        QString firstName = query.value(0).toString();
-        QString lastName = query.value(1).toString();
+    if (exec(*query) && query->next()) {
+        timer.addRows(1);
+        QString firstName = query->value(0).toString();
+        QString lastName = query->value(1).toString();
         return firstName + " " + lastName;
     }
 
@@ -252,19 +771,25 @@ QString DatabaseManager::getUserName(int userId) {
 }
 
 QString DatabaseManager::getUserPlanType(int userId) {
-    QSqlQuery query;
-    query.prepare("SELECT plan_type FROM users WHERE id = :id");
-    query.bindValue(":id", userId);
+    QueryTimer timer("getUserPlanType");
+    if (!isOpen() && !openDatabase()) {
+        timer.fail();
+        return "Standard";
+    }
+
+    CachedQuery query = cachedQuery("SELECT plan_type FROM users WHERE id = :id");
+    query->bindValue(":id", userId);
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toString();
+    if (exec(*query) && query->next()) {
+        timer.addRows(1);
+        return query->value(0).toString();
     }
 
     return "Standard"; // Valeur par défaut si non trouvé
 }
-bool DatabaseManager::createTables()
+bool DatabaseManager::createDirectoryTables()
 {
-    QSqlQuery query;
+    QSqlQuery query(m_database);
 
     // Table utilisateurs (updated to include stats fields)
     bool success = query.exec("CREATE TABLE IF NOT EXISTS users ("
@@ -289,20 +814,6 @@ bool DatabaseManager::createTables()
         qDebug() << "Erreur lors de la création de la table users:" << query.lastError().text();
         return false;
     }
-    // Table water_intake
-    success = query.exec("CREATE TABLE IF NOT EXISTS water_intake ("
-                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                         "user_id INTEGER NOT NULL, "
-                         "date TEXT NOT NULL, "
-                         "daily_goal INTEGER NOT NULL, "
-                         "current_amount INTEGER NOT NULL, "
-                         "FOREIGN KEY(user_id) REFERENCES users(id), "
-                         "UNIQUE(user_id, date)"
-                         ")");
-    if (!success) {
-        qDebug() << "Erreur lors de la création de la table water_intake:" << query.lastError().text();
-        return false;
-    }
     // Table user_goals
     success = query.exec("CREATE TABLE IF NOT EXISTS user_goals ("
                          "id INTEGER PRIMARY KEY AUTOINCREMENT, "
@@ -318,6 +829,32 @@ bool DatabaseManager::createTables()
         return false;
     }
 
+    return true;
+}
+
+bool DatabaseManager::createTables()
+{
+    if (!createDirectoryTables()) {
+        return false;
+    }
+
+    QSqlQuery query(m_database);
+
+    // Table water_intake
+    bool success = query.exec("CREATE TABLE IF NOT EXISTS water_intake ("
+                              "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                              "user_id INTEGER NOT NULL, "
+                              "date TEXT NOT NULL, "
+                              "daily_goal INTEGER NOT NULL, "
+                              "current_amount INTEGER NOT NULL, "
+                              "FOREIGN KEY(user_id) REFERENCES users(id), "
+                              "UNIQUE(user_id, date)"
+                              ")");
+    if (!success) {
+        qDebug() << "Erreur lors de la création de la table water_intake:" << query.lastError().text();
+        return false;
+    }
+
     // Table habits
     success = query.exec("CREATE TABLE IF NOT EXISTS habits ("
                          "id INTEGER PRIMARY KEY AUTOINCREMENT, "
@@ -327,115 +864,495 @@ bool DatabaseManager::createTables()
                          "goal_days INTEGER NOT NULL, "
                          "FOREIGN KEY(user_id) REFERENCES users(id), "
                          "UNIQUE(user_id, habit_id)"
+                              ")");
+
+    if (!success) {
+        qDebug() << "Erreur lors de la création de la table habits:" << query.lastError().text();
+        return false;
+    }
+
+    // Table meals
+    success = query.exec("CREATE TABLE IF NOT EXISTS meals ("
+                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                         "user_id INTEGER NOT NULL, "
+                         "day_of_week INTEGER NOT NULL, "
+                         "name TEXT NOT NULL, "
+                         "time TEXT NOT NULL, "
+                         "calories INTEGER NOT NULL, "
+                         "image_path TEXT, "
+                         "FOREIGN KEY(user_id) REFERENCES users(id), "
+                         "UNIQUE(user_id, day_of_week, name, time)"
+                         ")");
+    if (!success) {
+        qDebug() << "Erreur lors de la création de la table meals:" << query.lastError().text();
+        return false;
+    }
+
+    // Table meal_ingredients
+    success = query.exec("CREATE TABLE IF NOT EXISTS meal_ingredients ("
+                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                         "meal_id INTEGER NOT NULL, "
+                         "ingredient_name TEXT NOT NULL, "
+                         "quantity TEXT NOT NULL, "
+                         "FOREIGN KEY(meal_id) REFERENCES meals(id)"
+                         ")");
+    if (!success) {
+        qDebug() << "Erreur lors de la création de la table meal_ingredients:" << query.lastError().text();
+        return false;
+    }
+
+    // Table exercises
+    success = query.exec("CREATE TABLE IF NOT EXISTS exercises ("
+                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                         "user_id INTEGER NOT NULL, "
+                         "day_of_week INTEGER NOT NULL, "
+                         "name TEXT NOT NULL, "
+                         "duration TEXT NOT NULL, "
+                         "calories INTEGER NOT NULL, "
+                         "completed INTEGER NOT NULL DEFAULT 0, "
+                         "FOREIGN KEY(user_id) REFERENCES users(id), "
+                         "UNIQUE(user_id, day_of_week, name)"
                          ")");
+    if (!success) {
+        qDebug() << "Erreur lors de la création de la table exercises:" << query.lastError().text();
+        return false;
+    }
+    // Complétions d'habitudes : habit_completion_bitmaps (migration 4)
+
+    return true;
+}
+namespace {
+struct SchemaMigration
+{
+    int version;
+    QString description;
+    QStringList statements;
+    // Conversion de données exécutée après les instructions, dans la même transaction
+    bool (*convert)(QSqlDatabase &database) = nullptr;
+};
+
+// Version 4 : les lignes habit_completions (une par jour) sont regroupées en un
+// bitmap par habitude et par année, puis l'ancienne table est supprimée.
+// Une base créée après son abandon n'a pas la table : aucune ligne à convertir.
+bool convertHabitCompletionsToBitmaps(QSqlDatabase &database)
+{
+    if (!database.tables().contains("habit_completions")) {
+        return true;
+    }
+
+    QSqlQuery query(database);
+    if (!query.exec("SELECT user_id, habit_id, completion_date FROM habit_completions")) {
+        qDebug() << "Error reading habit completions:" << query.lastError().text();
+        return false;
+    }
+
+    QMap<QPair<int, int>, CompletionBitmap> bitmaps; // Clé : (user_id, habit_id)
+    while (query.next()) {
+        QDate date = QDate::fromString(query.value(2).toString(), Qt::ISODate);
+        if (date.isValid()) {
+            bitmaps[qMakePair(query.value(0).toInt(), query.value(1).toInt())].insert(date);
+        }
+    }
+    query.finish();
+
+    QSqlQuery insertQuery(database);
+    if (!insertQuery.prepare("INSERT OR REPLACE INTO habit_completion_bitmaps (user_id, habit_id, year, bits) "
+                             "VALUES (?, ?, ?, ?)")) {
+        qDebug() << "Error preparing habit bitmap insert:" << insertQuery.lastError().text();
+        return false;
+    }
+    for (auto it = bitmaps.constBegin(); it != bitmaps.constEnd(); ++it) {
+        for (int year : it.value().years()) {
+            insertQuery.bindValue(0, it.key().first);
+            insertQuery.bindValue(1, it.key().second);
+            insertQuery.bindValue(2, year);
+            insertQuery.bindValue(3, it.value().yearBlob(year));
+            if (!insertQuery.exec()) {
+                qDebug() << "Error converting habit completions:" << insertQuery.lastError().text();
+                return false;
+            }
+        }
+    }
+
+    if (!query.exec("DROP TABLE habit_completions")) {
+        qDebug() << "Error dropping habit completions:" << query.lastError().text();
+        return false;
+    }
+    qDebug() << "Complétions d'habitudes converties en" << bitmaps.size() << "bitmaps";
+    return true;
+}
+
+// Version 5 : résumés annuels (par habitude) et journées parfaites (par utilisateur)
+// calculés une fois pour les bitmaps existants
+bool backfillHabitYearSummaries(QSqlDatabase &database)
+{
+    QSqlQuery query(database);
+    QMap<int, int> habitCounts;
+    if (!query.exec("SELECT user_id, COUNT(*) FROM habits GROUP BY user_id")) {
+        qDebug() << "Error counting habits:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        habitCounts.insert(query.value(0).toInt(), query.value(1).toInt());
+    }
+
+    if (!query.exec("SELECT user_id, habit_id, year, bits FROM habit_completion_bitmaps")) {
+        qDebug() << "Error reading habit bitmaps:" << query.lastError().text();
+        return false;
+    }
+
+    QSqlQuery updateQuery(database);
+    if (!updateQuery.prepare("UPDATE habit_completion_bitmaps SET completed_days = ?, longest_run = ?, "
+                             "leading_run = ?, trailing_run = ? WHERE user_id = ? AND habit_id = ? AND year = ?")) {
+        qDebug() << "Error preparing summary update:" << updateQuery.lastError().text();
+        return false;
+    }
+
+    // (user_id, year) -> (habitudes présentes, intersection de leurs bitmaps)
+    QMap<QPair<int, int>, QPair<int, CompletionBitmap>> perfectDays;
+    while (query.next()) {
+        const int userId = query.value(0).toInt();
+        const int year = query.value(2).toInt();
+        CompletionBitmap bitmap;
+        bitmap.setYearBlob(year, query.value(3).toByteArray());
+
+        const CompletionBitmap::YearSummary summary = bitmap.summary(year);
+        updateQuery.addBindValue(summary.completedDays);
+        updateQuery.addBindValue(summary.longestRun);
+        updateQuery.addBindValue(summary.leadingRun);
+        updateQuery.addBindValue(summary.trailingRun);
+        updateQuery.addBindValue(userId);
+        updateQuery.addBindValue(query.value(1).toInt());
+        updateQuery.addBindValue(year);
+        if (!updateQuery.exec()) {
+            qDebug() << "Error updating habit summary:" << updateQuery.lastError().text();
+            return false;
+        }
+
+        QPair<int, CompletionBitmap> &entry = perfectDays[qMakePair(userId, year)];
+        entry.second = (entry.first == 0) ? bitmap : entry.second.intersected(bitmap);
+        entry.first++;
+    }
+    query.finish();
+
+    QSqlQuery insertQuery(database);
+    if (!insertQuery.prepare("INSERT OR REPLACE INTO habit_year_summaries (user_id, year, perfect_days) VALUES (?, ?, ?)")) {
+        qDebug() << "Error preparing perfect days insert:" << insertQuery.lastError().text();
+        return false;
+    }
+    for (auto it = perfectDays.constBegin(); it != perfectDays.constEnd(); ++it) {
+        // Un jour parfait valide toutes les habitudes de l'utilisateur
+        if (it.value().first != habitCounts.value(it.key().first) || it.value().second.isEmpty()) {
+            continue;
+        }
+        insertQuery.addBindValue(it.key().first);
+        insertQuery.addBindValue(it.key().second);
+        insertQuery.addBindValue(it.value().second.count());
+        if (!insertQuery.exec()) {
+            qDebug() << "Error inserting perfect days:" << insertQuery.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Ajout d'un événement à l'agrégat d'une période (%1 = période, %2 = début de période)
+const char *const kRollupUpsert =
+    "INSERT INTO workout_rollups (user_id, period, period_start, sessions, sets, calories, active_seconds) "
+    "VALUES (NEW.user_id, %1, %2, NEW.event_type = 'session', NEW.event_type = 'set', "
+    "CASE WHEN NEW.event_type = 'session' THEN NEW.calories ELSE 0 END, "
+    "CASE WHEN NEW.event_type = 'session' THEN NEW.duration_seconds ELSE 0 END) "
+    "ON CONFLICT(user_id, period, period_start) DO UPDATE SET "
+    "sessions = sessions + excluded.sessions, sets = sets + excluded.sets, "
+    "calories = calories + excluded.calories, active_seconds = active_seconds + excluded.active_seconds;";
+
+// Étapes appliquées dans l'ordre à partir de la version courante du fichier.
+// Une étape publiée ne doit plus être modifiée : ajouter une nouvelle version.
+// Version 0 = schéma créé par createTables().
+const QList<SchemaMigration> &schemaMigrations()
+{
+    static const QList<SchemaMigration> migrations = {
+        {1, "Index des requêtes fréquentes", {
+             // Jointure repas/ingrédients, DELETE par repas, contrôles d'intégrité.
+             // Le rowid est inclus implicitement : l'ORDER BY mi.id est servi par l'index.
+             "CREATE INDEX IF NOT EXISTS idx_meal_ingredients_meal ON meal_ingredients(meal_id)",
+             // loadMeals : WHERE user_id ORDER BY day_of_week, time sans tri temporaire
+             "CREATE INDEX IF NOT EXISTS idx_meals_user_day_time ON meals(user_id, day_of_week, time)"
+         }},
+        {2, "Journal d'entraînement et agrégats incrémentaux", {
+             "CREATE TABLE IF NOT EXISTS workout_events ("
+             "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+             "user_id INTEGER NOT NULL, "
+             "event_type TEXT NOT NULL CHECK(event_type IN ('set', 'session')), "
+             "exercise_name TEXT, "
+             "occurred_at TEXT NOT NULL, "
+             "duration_seconds INTEGER NOT NULL DEFAULT 0, "
+             "calories INTEGER NOT NULL DEFAULT 0, "
+             "FOREIGN KEY(user_id) REFERENCES users(id)"
+             ")",
+             "CREATE INDEX IF NOT EXISTS idx_workout_events_user_time ON workout_events(user_id, occurred_at)",
+             // period_start : jour, lundi de la semaine ou premier du mois (yyyy-MM-dd)
+             "CREATE TABLE IF NOT EXISTS workout_rollups ("
+             "user_id INTEGER NOT NULL, "
+             "period TEXT NOT NULL CHECK(period IN ('day', 'week', 'month')), "
+             "period_start TEXT NOT NULL, "
+             "sessions INTEGER NOT NULL DEFAULT 0, "
+             "sets INTEGER NOT NULL DEFAULT 0, "
+             "calories INTEGER NOT NULL DEFAULT 0, "
+             "active_seconds INTEGER NOT NULL DEFAULT 0, "
+             "PRIMARY KEY(user_id, period, period_start)"
+             ") WITHOUT ROWID",
+             // Les séries ne comptent que dans sets : durée et calories sont portées par
+             // l'événement de séance pour ne pas être additionnées deux fois
+             QString("CREATE TRIGGER IF NOT EXISTS trg_workout_events_rollup AFTER INSERT ON workout_events "
+                     "BEGIN %1 %2 %3 END")
+                 .arg(QString(kRollupUpsert).arg("'day'", "date(NEW.occurred_at)"),
+                      QString(kRollupUpsert).arg("'week'", "date(NEW.occurred_at, 'weekday 0', '-6 days')"),
+                      QString(kRollupUpsert).arg("'month'", "date(NEW.occurred_at, 'start of month')"))
+         }},
+        {3, "Macronutriments des repas", {
+             // Grammes par repas ; les lignes existantes restent à 0 jusqu'à leur prochaine sauvegarde
+             "ALTER TABLE meals ADD COLUMN protein_g INTEGER NOT NULL DEFAULT 0",
+             "ALTER TABLE meals ADD COLUMN carbs_g INTEGER NOT NULL DEFAULT 0",
+             "ALTER TABLE meals ADD COLUMN fat_g INTEGER NOT NULL DEFAULT 0"
+         }},
+        {4, "Historique des habitudes en bitmaps annuels", {
+             // bits : CompletionBitmap::yearBlob, 46 octets pour les 366 jours de l'année
+             "CREATE TABLE IF NOT EXISTS habit_completion_bitmaps ("
+             "user_id INTEGER NOT NULL, "
+             "habit_id INTEGER NOT NULL, "
+             "year INTEGER NOT NULL, "
+             "bits BLOB NOT NULL, "
+             "PRIMARY KEY(user_id, habit_id, year)"
+             ") WITHOUT ROWID"
+         }, convertHabitCompletionsToBitmaps},
+        {5, "Résumés annuels de l'historique des habitudes", {
+             // CompletionBitmap::summary : séries et records sans lire les blobs anciens
+             "ALTER TABLE habit_completion_bitmaps ADD COLUMN completed_days INTEGER NOT NULL DEFAULT 0",
+             "ALTER TABLE habit_completion_bitmaps ADD COLUMN longest_run INTEGER NOT NULL DEFAULT 0",
+             "ALTER TABLE habit_completion_bitmaps ADD COLUMN leading_run INTEGER NOT NULL DEFAULT 0",
+             "ALTER TABLE habit_completion_bitmaps ADD COLUMN trailing_run INTEGER NOT NULL DEFAULT 0",
+             // Jours où toutes les habitudes de l'utilisateur sont validées (années sans jour parfait absentes)
+             "CREATE TABLE IF NOT EXISTS habit_year_summaries ("
+             "user_id INTEGER NOT NULL, "
+             "year INTEGER NOT NULL, "
+             "perfect_days INTEGER NOT NULL DEFAULT 0, "
+             "PRIMARY KEY(user_id, year)"
+             ") WITHOUT ROWID"
+         }, backfillHabitYearSummaries},
+        {6, "Suppression de l'ancienne table habit_completions", {
+             // Bases passées par une version 4 qui vidait la table sans la supprimer
+             "DROP TABLE IF EXISTS habit_completions"
+         }},
+        {7, "Retrait des macronutriments estimés", {
+             // Bases passées par une version de l'étape 3 qui déduisait les grammes des calories
+             // (20/50/30 % de l'énergie) : ces valeurs inventées redeviennent inconnues (0)
+             "UPDATE meals SET protein_g = 0, carbs_g = 0, fat_g = 0 "
+             "WHERE protein_g = CAST(ROUND(CAST(calories AS INTEGER) * 0.20 / 4) AS INTEGER) "
+             "AND carbs_g = CAST(ROUND(CAST(calories AS INTEGER) * 0.50 / 4) AS INTEGER) "
+             "AND fat_g = CAST(ROUND(CAST(calories AS INTEGER) * 0.30 / 9) AS INTEGER)"
+         }},
+    };
+    return migrations;
+}
+}
+
+int DatabaseManager::schemaVersion()
+{
+    QSqlQuery query(m_database);
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt();
+    }
+    qDebug() << "Error reading schema version:" << query.lastError().text();
+    return -1;
+}
+
+bool DatabaseManager::migrateSchema()
+{
+    const int currentVersion = schemaVersion();
+    if (currentVersion < 0) {
+        return false;
+    }
+
+    m_appliedMigrations.clear();
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    for (const SchemaMigration &migration : schemaMigrations()) {
+        if (migration.version <= currentVersion) {
+            continue;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        // Chaque étape est atomique : en cas d'échec, le fichier reste à la version précédente
+        Transaction transaction(*this);
+        if (!transaction.isActive()) {
+            return false;
+        }
+
+        QSqlQuery query(m_database);
+        for (const QString &statement : migration.statements) {
+            if (!query.exec(statement)) {
+                qDebug() << "Error applying migration" << migration.version << ":" << query.lastError().text();
+                return false;
+            }
+        }
+        if (migration.convert && !migration.convert(m_database)) {
+            qDebug() << "Error converting data for migration" << migration.version;
+            return false;
+        }
+        if (!query.exec(QString("PRAGMA user_version = %1").arg(migration.version))) {
+            qDebug() << "Error updating schema version:" << query.lastError().text();
+            return false;
+        }
+        query.finish();
 
-    if (!success) {
-        qDebug() << "Erreur lors de la création de la table habits:" << query.lastError().text();
-        return false;
+        if (!transaction.commit()) {
+            return false;
+        }
+
+        MigrationRecord record;
+        record.version = migration.version;
+        record.description = migration.description;
+        record.elapsedMs = timer.elapsed();
+        m_appliedMigrations.append(record);
+        qDebug() << "Migration" << record.version << "(" << record.description << ") appliquée en"
+                 << record.elapsedMs << "ms";
     }
 
-    // Table meals
-    success = query.exec("CREATE TABLE IF NOT EXISTS meals ("
-                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                         "user_id INTEGER NOT NULL, "
-                         "day_of_week INTEGER NOT NULL, "
-                         "name TEXT NOT NULL, "
-                         "time TEXT NOT NULL, "
-                         "calories INTEGER NOT NULL, "
-                         "image_path TEXT, "
-                         "FOREIGN KEY(user_id) REFERENCES users(id), "
-                         "UNIQUE(user_id, day_of_week, name, time)"
-                         ")");
-    if (!success) {
-        qDebug() << "Erreur lors de la création de la table meals:" << query.lastError().text();
+    if (!m_appliedMigrations.isEmpty()) {
+        // Met à jour les statistiques du planificateur pour les nouveaux index
+        QSqlQuery query(m_database);
+        query.exec("PRAGMA optimize");
+        qDebug() << "Schéma migré de la version" << currentVersion << "à" << m_appliedMigrations.last().version
+                 << "en" << totalTimer.elapsed() << "ms";
+    }
+    return true;
+}
+
+bool DatabaseManager::recordWorkoutEvent(int userId, const WorkoutEvent &event)
+{
+    QueryTimer timer("recordWorkoutEvent");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
-    // Table meal_ingredients
-    success = query.exec("CREATE TABLE IF NOT EXISTS meal_ingredients ("
-                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                         "meal_id INTEGER NOT NULL, "
-                         "ingredient_name TEXT NOT NULL, "
-                         "quantity TEXT NOT NULL, "
-                         "FOREIGN KEY(meal_id) REFERENCES meals(id)"
-                         ")");
-    if (!success) {
-        qDebug() << "Erreur lors de la création de la table meal_ingredients:" << query.lastError().text();
+    // L'insertion et la mise à jour des agrégats (trigger) sont atomiques
+    CachedQuery query = cachedQuery("INSERT INTO workout_events (user_id, event_type, exercise_name, occurred_at, "
+                                    "duration_seconds, calories) "
+                                    "VALUES (:user_id, :type, :exercise, :occurred_at, :duration, :calories)");
+    query->bindValue(":user_id", userId);
+    query->bindValue(":type", event.type == WorkoutEventType::Session ? "session" : "set");
+    query->bindValue(":exercise", event.exerciseName);
+    query->bindValue(":occurred_at", event.occurredAt.toString("yyyy-MM-ddTHH:mm:ss"));
+    query->bindValue(":duration", event.durationSeconds);
+    query->bindValue(":calories", event.calories);
+
+    if (!exec(*query)) {
+        qDebug() << "Error recording workout event:" << query->lastError().text();
+        timer.fail();
         return false;
     }
+    timer.addRows(query->numRowsAffected());
+    return true;
+}
 
-    // Table exercises
-    success = query.exec("CREATE TABLE IF NOT EXISTS exercises ("
-                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                         "user_id INTEGER NOT NULL, "
-                         "day_of_week INTEGER NOT NULL, "
-                         "name TEXT NOT NULL, "
-                         "duration TEXT NOT NULL, "
-                         "calories INTEGER NOT NULL, "
-                         "completed INTEGER NOT NULL DEFAULT 0, "
-                         "FOREIGN KEY(user_id) REFERENCES users(id), "
-                         "UNIQUE(user_id, day_of_week, name)"
-                         ")");
-    if (!success) {
-        qDebug() << "Erreur lors de la création de la table exercises:" << query.lastError().text();
+bool DatabaseManager::loadWorkoutRollup(int userId, RollupPeriod period, const QDate &date, WorkoutRollup &rollup)
+{
+    QueryTimer timer("loadWorkoutRollup");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
-    // Table habit_completions
-    success = query.exec("CREATE TABLE IF NOT EXISTS habit_completions ("
-                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                         "user_id INTEGER NOT NULL, "
-                         "habit_id INTEGER NOT NULL, "
-                         "completion_date DATE NOT NULL, "
-                         "FOREIGN KEY(user_id) REFERENCES users(id), "
-                         "UNIQUE(user_id, habit_id, completion_date)"
-                         ")");
 
-    if (!success) {
-        qDebug() << "Erreur lors de la création de la table habit_completions:" << query.lastError().text();
+    // Même découpage que le trigger : semaine du lundi au dimanche
+    QString periodName;
+    QDate periodStart;
+    switch (period) {
+    case RollupPeriod::Day:
+        periodName = "day";
+        periodStart = date;
+        break;
+    case RollupPeriod::Week:
+        periodName = "week";
+        periodStart = date.addDays(1 - date.dayOfWeek());
+        break;
+    case RollupPeriod::Month:
+        periodName = "month";
+        periodStart = QDate(date.year(), date.month(), 1);
+        break;
+    }
+
+    CachedQuery query = cachedQuery("SELECT sessions, sets, calories, active_seconds FROM workout_rollups "
+                                    "WHERE user_id = :user_id AND period = :period AND period_start = :start");
+    query->bindValue(":user_id", userId);
+    query->bindValue(":period", periodName);
+    query->bindValue(":start", periodStart.toString("yyyy-MM-dd"));
+
+    if (!exec(*query)) {
+        qDebug() << "Error loading workout rollup:" << query->lastError().text();
+        timer.fail();
         return false;
     }
 
-    return true;
+    rollup = WorkoutRollup();
+    if (query->next()) {
+        timer.addRows(1);
+        rollup.sessions = query->value(0).toInt();
+        rollup.sets = query->value(1).toInt();
+        rollup.calories = query->value(2).toInt();
+        rollup.activeSeconds = query->value(3).toInt();
+    }
+    return true; // Aucune ligne : période sans activité
 }
+
 bool DatabaseManager::updateUserStats(int userId, int workoutSessions, int caloriesBurned, int activityMinutes, int exercisesDone)
 {
+    QueryTimer timer("updateUserStats");
     if (!isOpen() && !openDatabase()) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
-    query.prepare("UPDATE users SET workout_sessions = :sessions, "
-                  "calories_burned = :calories, activity_minutes = :minutes, "
-                  "exercises_done = :exercises WHERE id = :id");
-    query.bindValue(":sessions", workoutSessions);
-    query.bindValue(":calories", caloriesBurned);
-    query.bindValue(":minutes", activityMinutes);
-    query.bindValue(":exercises", exercisesDone);
-    query.bindValue(":id", userId);
+    CachedQuery query = cachedQuery("UPDATE users SET workout_sessions = :sessions, "
+                                    "calories_burned = :calories, activity_minutes = :minutes, "
+                                    "exercises_done = :exercises WHERE id = :id");
+    query->bindValue(":sessions", workoutSessions);
+    query->bindValue(":calories", caloriesBurned);
+    query->bindValue(":minutes", activityMinutes);
+    query->bindValue(":exercises", exercisesDone);
+    query->bindValue(":id", userId);
 
-    if (!query.exec()) {
-        qDebug() << "Error updating user stats:" << query.lastError().text();
+    if (!exec(*query)) {
+        qDebug() << "Error updating user stats:" << query->lastError().text();
+        timer.fail();
         return false;
     }
+    timer.addRows(query->numRowsAffected());
     return true;
 }
 
 bool DatabaseManager::loadUserStats(int userId, int &workoutSessions, int &caloriesBurned, int &activityMinutes, int &exercisesDone)
 {
+    QueryTimer timer("loadUserStats");
     if (!isOpen() && !openDatabase()) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
-    query.prepare("SELECT workout_sessions, calories_burned, activity_minutes, exercises_done "
-                  "FROM users WHERE id = :id");
-    query.bindValue(":id", userId);
+    CachedQuery query = cachedQuery("SELECT workout_sessions, calories_burned, activity_minutes, exercises_done "
+                                    "FROM users WHERE id = :id");
+    query->bindValue(":id", userId);
 
-    if (query.exec() && query.next()) {
-        workoutSessions = query.value(0).toInt();
-        caloriesBurned = query.value(1).toInt();
-        activityMinutes = query.value(2).toInt();
-        exercisesDone = query.value(3).toInt();
+    if (exec(*query) && query->next()) {
+        timer.addRows(1);
+        workoutSessions = query->value(0).toInt();
+        caloriesBurned = query->value(1).toInt();
+        activityMinutes = query->value(2).toInt();
+        exercisesDone = query->value(3).toInt();
         return true;
     }
     return false;
@@ -443,407 +1360,784 @@ bool DatabaseManager::loadUserStats(int userId, int &workoutSessions, int &calor
 
 bool DatabaseManager::saveUserGoals(int userId, const QMap<QString, int> &goals)
 {
+    QueryTimer timer("saveUserGoals");
     if (!isOpen() && !openDatabase()) {
+        timer.fail();
+        return false;
+    }
+
+    Transaction transaction(*this);
+    if (!transaction.isActive()) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
+    CachedQuery query = cachedQuery("INSERT OR REPLACE INTO user_goals (user_id, goal_name, progress) "
+                                    "VALUES (:user_id, :goal_name, :progress)");
     for (auto it = goals.constBegin(); it != goals.constEnd(); ++it) {
-        query.prepare("INSERT OR REPLACE INTO user_goals (user_id, goal_name, progress) "
-                      "VALUES (:user_id, :goal_name, :progress)");
-        query.bindValue(":user_id", userId);
-        query.bindValue(":goal_name", it.key());
-        query.bindValue(":progress", it.value());
-
-        if (!query.exec()) {
-            qDebug() << "Error saving user goal:" << query.lastError().text();
+        query->bindValue(":user_id", userId);
+        query->bindValue(":goal_name", it.key());
+        query->bindValue(":progress", it.value());
+
+        if (!exec(*query)) {
+            qDebug() << "Error saving user goal:" << query->lastError().text();
+            timer.fail();
             return false;
         }
+        timer.addRows(query->numRowsAffected());
     }
-    return true;
+    return timer.check(transaction.commit());
 }
 
 bool DatabaseManager::loadUserGoals(int userId, QMap<QString, int> &goals)
 {
+    QueryTimer timer("loadUserGoals");
     if (!isOpen() && !openDatabase()) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
-    query.prepare("SELECT goal_name, progress FROM user_goals WHERE user_id = :user_id");
-    query.bindValue(":user_id", userId);
+    CachedQuery query = cachedQuery("SELECT goal_name, progress FROM user_goals WHERE user_id = :user_id");
+    query->bindValue(":user_id", userId);
 
     goals.clear();
-    if (query.exec()) {
-        while (query.next()) {
-            goals[query.value(0).toString()] = query.value(1).toInt();
+    if (exec(*query)) {
+        while (query->next()) {
+            timer.addRows(1);
+            goals[query->value(0).toString()] = query->value(1).toInt();
         }
         return true;
     }
-    qDebug() << "Error loading user goals:" << query.lastError().text();
+    qDebug() << "Error loading user goals:" << query->lastError().text();
+    timer.fail();
     return false;
 }
 
-bool DatabaseManager::saveHabit(int userId, int habitId, const QString &name, int goalDays, const QSet<QDate> &completedDates)
+bool DatabaseManager::saveHabit(int userId, int habitId, const QString &name, int goalDays, const CompletionBitmap &completedDates)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("saveHabit");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
+    Transaction transaction(*this);
+    if (!transaction.isActive()) {
+        timer.fail();
+        return false;
+    }
 
     // Save or update habit
-    query.prepare("INSERT OR REPLACE INTO habits (user_id, habit_id, name, goal_days) "
-                  "VALUES (:user_id, :habit_id, :name, :goal_days)");
-    query.bindValue(":user_id", userId);
-    query.bindValue(":habit_id", habitId);
-    query.bindValue(":name", name);
-    query.bindValue(":goal_days", goalDays);
-
-    if (!query.exec()) {
-        qDebug() << "Error saving habit:" << query.lastError().text();
+    CachedQuery habitQuery = cachedQuery("INSERT OR REPLACE INTO habits (user_id, habit_id, name, goal_days) "
+                                         "VALUES (:user_id, :habit_id, :name, :goal_days)");
+    habitQuery->bindValue(":user_id", userId);
+    habitQuery->bindValue(":habit_id", habitId);
+    habitQuery->bindValue(":name", name);
+    habitQuery->bindValue(":goal_days", goalDays);
+
+    if (!exec(*habitQuery)) {
+        qDebug() << "Error saving habit:" << habitQuery->lastError().text();
+        timer.fail();
         return false;
     }
+    timer.addRows(habitQuery->numRowsAffected());
 
     // Clear existing completions for this habit
-    query.prepare("DELETE FROM habit_completions WHERE user_id = :user_id AND habit_id = :habit_id");
-    query.bindValue(":user_id", userId);
-    query.bindValue(":habit_id", habitId);
-    if (!query.exec()) {
-        qDebug() << "Error clearing habit completions:" << query.lastError().text();
+    CachedQuery clearQuery = cachedQuery("DELETE FROM habit_completion_bitmaps WHERE user_id = :user_id AND habit_id = :habit_id");
+    clearQuery->bindValue(":user_id", userId);
+    clearQuery->bindValue(":habit_id", habitId);
+    if (!exec(*clearQuery)) {
+        qDebug() << "Error clearing habit completions:" << clearQuery->lastError().text();
+        timer.fail();
         return false;
     }
-
-    // Save new completions
-    for (const QDate &date : completedDates) {
-        query.prepare("INSERT INTO habit_completions (user_id, habit_id, completion_date) "
-                      "VALUES (:user_id, :habit_id, :date)");
-        query.bindValue(":user_id", userId);
-        query.bindValue(":habit_id", habitId);
-        query.bindValue(":date", date.toString("yyyy-MM-dd"));
-        if (!query.exec()) {
-            qDebug() << "Error saving habit completion:" << query.lastError().text();
+    timer.addRows(clearQuery->numRowsAffected());
+
+    // Save new completions : une ligne par année d'historique
+    CachedQuery completionQuery = cachedQuery("INSERT INTO habit_completion_bitmaps (user_id, habit_id, year, bits, "
+                                              "completed_days, longest_run, leading_run, trailing_run) "
+                                              "VALUES (:user_id, :habit_id, :year, :bits, "
+                                              ":completed_days, :longest_run, :leading_run, :trailing_run)");
+    for (int year : completedDates.years()) {
+        const CompletionBitmap::YearSummary summary = completedDates.summary(year);
+        completionQuery->bindValue(":user_id", userId);
+        completionQuery->bindValue(":habit_id", habitId);
+        completionQuery->bindValue(":year", year);
+        completionQuery->bindValue(":bits", completedDates.yearBlob(year));
+        completionQuery->bindValue(":completed_days", summary.completedDays);
+        completionQuery->bindValue(":longest_run", summary.longestRun);
+        completionQuery->bindValue(":leading_run", summary.leadingRun);
+        completionQuery->bindValue(":trailing_run", summary.trailingRun);
+        if (!exec(*completionQuery)) {
+            qDebug() << "Error saving habit completion:" << completionQuery->lastError().text();
+            timer.fail();
             return false;
         }
+        timer.addRows(completionQuery->numRowsAffected());
     }
-    return true;
+
+    // Nouvelle habitude ou historique réécrit : les journées parfaites de toutes les années changent
+    if (!refreshPerfectDays(userId)) {
+        timer.fail();
+        return false;
+    }
+    return timer.check(transaction.commit());
 }
 
-bool DatabaseManager::loadHabits(int userId, QMap<int, QMap<QString, QVariant>> &habits)
+bool DatabaseManager::loadHabits(int userId, QMap<int, Habit> &habits, int fromYear)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("loadHabits");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
     habits.clear();
 
     // Load habits
-    QSqlQuery habitQuery;
-    habitQuery.prepare("SELECT habit_id, name, goal_days FROM habits WHERE user_id = :user_id");
-    habitQuery.bindValue(":user_id", userId);
-
-    if (habitQuery.exec()) {
-        while (habitQuery.next()) {
-            int habitId = habitQuery.value(0).toInt();
-            QMap<QString, QVariant> habitData;
-            habitData["name"] = habitQuery.value(1).toString();
-            habitData["goalDays"] = habitQuery.value(2).toInt();
-
-            // Load completions for this habit
-            QSet<QDate> completedDates;
-            QSqlQuery completionQuery;
-            completionQuery.prepare("SELECT completion_date FROM habit_completions "
-                                    "WHERE user_id = :user_id AND habit_id = :habit_id");
-            completionQuery.bindValue(":user_id", userId);
-            completionQuery.bindValue(":habit_id", habitId);
-
-            if (completionQuery.exec()) {
-                while (completionQuery.next()) {
-                    QDate date = QDate::fromString(completionQuery.value(0).toString(), "yyyy-MM-dd");
-                    if (date.isValid()) {
-                        completedDates.insert(date);
-                    }
-                }
-            } else {
-                qDebug() << "Error loading habit completions:" << completionQuery.lastError().text();
-                return false;
-            }
+    CachedQuery habitQuery = cachedQuery("SELECT habit_id, name, goal_days FROM habits WHERE user_id = :user_id");
+    habitQuery->bindValue(":user_id", userId);
+
+    if (!exec(*habitQuery)) {
+        qDebug() << "Error loading habits:" << habitQuery->lastError().text();
+        timer.fail();
+        return false;
+    }
+
+    while (habitQuery->next()) {
+        timer.addRows(1);
+        habits.insert(habitQuery->value(0).toInt(),
+                      Habit(habitQuery->value(1).toString(), habitQuery->value(2).toInt()));
+    }
+
+    // Un seul parcours de habit_completion_bitmaps pour tout l'utilisateur : une ligne
+    // par habitude et par année, copiée telle quelle dans le bitmap de chaque Habit
+    CachedQuery completionQuery = cachedQuery("SELECT habit_id, year, bits FROM habit_completion_bitmaps "
+                                              "WHERE user_id = :user_id AND year >= :from_year ORDER BY habit_id, year");
+    completionQuery->bindValue(":user_id", userId);
+    completionQuery->bindValue(":from_year", fromYear);
 
-            habitData["completedDates"] = QVariant::fromValue(completedDates);
-            habits[habitId] = habitData;
+    if (!exec(*completionQuery)) {
+        qDebug() << "Error loading habit completions:" << completionQuery->lastError().text();
+        timer.fail();
+        return false;
+    }
+
+    int currentHabitId = -1;
+    CompletionBitmap *completedDates = nullptr;
+    while (completionQuery->next()) {
+        timer.addRows(1);
+        int habitId = completionQuery->value(0).toInt();
+        if (habitId != currentHabitId) {
+            currentHabitId = habitId;
+            auto it = habits.find(habitId);
+            completedDates = (it != habits.end()) ? &it->completedDates : nullptr;
         }
-        return true;
+        if (!completedDates) {
+            continue; // Complétion d'une habitude supprimée
+        }
+
+        completedDates->setYearBlob(completionQuery->value(1).toInt(), completionQuery->value(2).toByteArray());
     }
-    qDebug() << "Error loading habits:" << habitQuery.lastError().text();
-    return false;
+    completionQuery->finish();
+
+    // Années plus anciennes : quatre entiers par année, sans le blob
+    CachedQuery summaryQuery = cachedQuery("SELECT habit_id, year, completed_days, longest_run, leading_run, trailing_run "
+                                           "FROM habit_completion_bitmaps WHERE user_id = :user_id AND year < :from_year");
+    summaryQuery->bindValue(":user_id", userId);
+    summaryQuery->bindValue(":from_year", fromYear);
+    if (!exec(*summaryQuery)) {
+        qDebug() << "Error loading habit summaries:" << summaryQuery->lastError().text();
+        timer.fail();
+        return false;
+    }
+    while (summaryQuery->next()) {
+        timer.addRows(1);
+        auto it = habits.find(summaryQuery->value(0).toInt());
+        if (it == habits.end()) {
+            continue;
+        }
+        CompletionBitmap::YearSummary summary;
+        summary.completedDays = summaryQuery->value(2).toInt();
+        summary.longestRun = summaryQuery->value(3).toInt();
+        summary.leadingRun = summaryQuery->value(4).toInt();
+        summary.trailingRun = summaryQuery->value(5).toInt();
+        it->archivedYears.insert(summaryQuery->value(1).toInt(), summary);
+    }
+    return true;
+}
+
+bool DatabaseManager::loadHabitYear(int userId, int year, QMap<int, CompletionBitmap> &completions)
+{
+    QueryTimer timer("loadHabitYear");
+    if (!openForUser(userId)) {
+        timer.fail();
+        return false;
+    }
+
+    completions.clear();
+    CachedQuery query = cachedQuery("SELECT habit_id, bits FROM habit_completion_bitmaps "
+                                    "WHERE user_id = :user_id AND year = :year");
+    query->bindValue(":user_id", userId);
+    query->bindValue(":year", year);
+
+    if (!exec(*query)) {
+        qDebug() << "Error loading habit year:" << query->lastError().text();
+        timer.fail();
+        return false;
+    }
+    while (query->next()) {
+        timer.addRows(1);
+        completions[query->value(0).toInt()].setYearBlob(year, query->value(1).toByteArray());
+    }
+    return true;
+}
+
+bool DatabaseManager::loadArchivedPerfectDays(int userId, int beforeYear, QMap<int, int> &perfectDays)
+{
+    QueryTimer timer("loadArchivedPerfectDays");
+    if (!openForUser(userId)) {
+        timer.fail();
+        return false;
+    }
+
+    perfectDays.clear();
+    CachedQuery query = cachedQuery("SELECT year, perfect_days FROM habit_year_summaries "
+                                    "WHERE user_id = :user_id AND year < :before_year");
+    query->bindValue(":user_id", userId);
+    query->bindValue(":before_year", beforeYear);
+
+    if (!exec(*query)) {
+        qDebug() << "Error loading perfect days:" << query->lastError().text();
+        timer.fail();
+        return false;
+    }
+    while (query->next()) {
+        timer.addRows(1);
+        perfectDays.insert(query->value(0).toInt(), query->value(1).toInt());
+    }
+    return true;
+}
+
+// Recalcule habit_year_summaries à partir des bitmaps (une année ou toutes) :
+// ET des bitmaps de l'année, à condition que chaque habitude y ait une ligne
+bool DatabaseManager::refreshPerfectDays(int userId, int year)
+{
+    const int fromYear = year > 0 ? year : 0;
+    const int toYear = year > 0 ? year : 9999;
+
+    CachedQuery countQuery = cachedQuery("SELECT COUNT(*) FROM habits WHERE user_id = :user_id");
+    countQuery->bindValue(":user_id", userId);
+    if (!exec(*countQuery) || !countQuery->next()) {
+        qDebug() << "Error counting habits:" << countQuery->lastError().text();
+        return false;
+    }
+    const int habitCount = countQuery->value(0).toInt();
+    countQuery->finish();
+
+    CachedQuery bitsQuery = cachedQuery("SELECT year, bits FROM habit_completion_bitmaps "
+                                        "WHERE user_id = :user_id AND year BETWEEN :from_year AND :to_year");
+    bitsQuery->bindValue(":user_id", userId);
+    bitsQuery->bindValue(":from_year", fromYear);
+    bitsQuery->bindValue(":to_year", toYear);
+    if (!exec(*bitsQuery)) {
+        qDebug() << "Error reading habit bitmaps:" << bitsQuery->lastError().text();
+        return false;
+    }
+
+    QMap<int, QPair<int, CompletionBitmap>> years; // Année -> (habitudes présentes, intersection)
+    while (bitsQuery->next()) {
+        const int rowYear = bitsQuery->value(0).toInt();
+        CompletionBitmap bitmap;
+        bitmap.setYearBlob(rowYear, bitsQuery->value(1).toByteArray());
+        QPair<int, CompletionBitmap> &entry = years[rowYear];
+        entry.second = (entry.first == 0) ? bitmap : entry.second.intersected(bitmap);
+        entry.first++;
+    }
+    bitsQuery->finish();
+
+    CachedQuery clearQuery = cachedQuery("DELETE FROM habit_year_summaries "
+                                         "WHERE user_id = :user_id AND year BETWEEN :from_year AND :to_year");
+    clearQuery->bindValue(":user_id", userId);
+    clearQuery->bindValue(":from_year", fromYear);
+    clearQuery->bindValue(":to_year", toYear);
+    if (!exec(*clearQuery)) {
+        qDebug() << "Error clearing perfect days:" << clearQuery->lastError().text();
+        return false;
+    }
+
+    CachedQuery insertQuery = cachedQuery("INSERT INTO habit_year_summaries (user_id, year, perfect_days) "
+                                          "VALUES (:user_id, :year, :perfect_days)");
+    for (auto it = years.constBegin(); it != years.constEnd(); ++it) {
+        if (it.value().first != habitCount || it.value().second.isEmpty()) {
+            continue;
+        }
+        insertQuery->bindValue(":user_id", userId);
+        insertQuery->bindValue(":year", it.key());
+        insertQuery->bindValue(":perfect_days", it.value().second.count());
+        if (!exec(*insertQuery)) {
+            qDebug() << "Error saving perfect days:" << insertQuery->lastError().text();
+            return false;
+        }
+    }
+    return true;
 }
 
 bool DatabaseManager::deleteHabit(int userId, int habitId)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("deleteHabit");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
+    Transaction transaction(*this);
+    if (!transaction.isActive()) {
+        timer.fail();
+        return false;
+    }
 
     // Delete habit completions
-    query.prepare("DELETE FROM habit_completions WHERE user_id = :user_id AND habit_id = :habit_id");
-    query.bindValue(":user_id", userId);
-    query.bindValue(":habit_id", habitId);
-    if (!query.exec()) {
-        qDebug() << "Error deleting habit completions:" << query.lastError().text();
+    CachedQuery completionQuery = cachedQuery("DELETE FROM habit_completion_bitmaps WHERE user_id = :user_id AND habit_id = :habit_id");
+    completionQuery->bindValue(":user_id", userId);
+    completionQuery->bindValue(":habit_id", habitId);
+    if (!exec(*completionQuery)) {
+        qDebug() << "Error deleting habit completions:" << completionQuery->lastError().text();
+        timer.fail();
         return false;
     }
+    timer.addRows(completionQuery->numRowsAffected());
 
     // Delete habit
-    query.prepare("DELETE FROM habits WHERE user_id = :user_id AND habit_id = :habit_id");
-    query.bindValue(":user_id", userId);
-    query.bindValue(":habit_id", habitId);
-    if (!query.exec()) {
-        qDebug() << "Error deleting habit:" << query.lastError().text();
+    CachedQuery habitQuery = cachedQuery("DELETE FROM habits WHERE user_id = :user_id AND habit_id = :habit_id");
+    habitQuery->bindValue(":user_id", userId);
+    habitQuery->bindValue(":habit_id", habitId);
+    if (!exec(*habitQuery)) {
+        qDebug() << "Error deleting habit:" << habitQuery->lastError().text();
+        timer.fail();
         return false;
     }
-    return true;
+    timer.addRows(habitQuery->numRowsAffected());
+
+    // Une habitude de moins : des journées deviennent parfaites
+    if (!refreshPerfectDays(userId)) {
+        timer.fail();
+        return false;
+    }
+    return timer.check(transaction.commit());
+}
+
+bool DatabaseManager::addHabitCompletion(int userId, int habitId, const QDate &date)
+{
+    QueryTimer timer("addHabitCompletion");
+    if (!openForUser(userId)) {
+        timer.fail();
+        return false;
+    }
+
+    qint64 rows = 0;
+    const bool success = updateHabitCompletion(userId, habitId, date, true, rows);
+    timer.addRows(rows);
+    if (!success) {
+        qDebug() << "Error adding habit completion";
+    }
+    return timer.check(success);
+}
+
+bool DatabaseManager::removeHabitCompletion(int userId, int habitId, const QDate &date)
+{
+    QueryTimer timer("removeHabitCompletion");
+    if (!openForUser(userId)) {
+        timer.fail();
+        return false;
+    }
+
+    qint64 rows = 0;
+    const bool success = updateHabitCompletion(userId, habitId, date, false, rows);
+    timer.addRows(rows);
+    if (!success) {
+        qDebug() << "Error removing habit completion";
+    }
+    return timer.check(success);
+}
+
+// Lecture-modification-écriture du bitmap de l'année concernée (46 octets),
+// dans une transaction pour ne pas perdre une date écrite en parallèle
+bool DatabaseManager::updateHabitCompletion(int userId, int habitId, const QDate &date, bool completed,
+                                            qint64 &rowsAffected)
+{
+    if (!date.isValid()) {
+        return false;
+    }
+
+    Transaction transaction(*this);
+    if (!transaction.isActive()) {
+        return false;
+    }
+
+    CompletionBitmap bitmap;
+    CachedQuery selectQuery = cachedQuery("SELECT bits FROM habit_completion_bitmaps "
+                                          "WHERE user_id = :user_id AND habit_id = :habit_id AND year = :year");
+    selectQuery->bindValue(":user_id", userId);
+    selectQuery->bindValue(":habit_id", habitId);
+    selectQuery->bindValue(":year", date.year());
+    if (!exec(*selectQuery)) {
+        qDebug() << "Error reading habit completions:" << selectQuery->lastError().text();
+        return false;
+    }
+    if (selectQuery->next()) {
+        rowsAffected += 1;
+        bitmap.setYearBlob(date.year(), selectQuery->value(0).toByteArray());
+    }
+    selectQuery->finish();
+
+    if (bitmap.contains(date) == completed) {
+        return transaction.commit(); // Déjà à jour
+    }
+    if (completed) {
+        bitmap.insert(date);
+    } else {
+        bitmap.remove(date);
+    }
+
+    if (bitmap.isEmpty()) {
+        CachedQuery deleteQuery = cachedQuery("DELETE FROM habit_completion_bitmaps "
+                                              "WHERE user_id = :user_id AND habit_id = :habit_id AND year = :year");
+        deleteQuery->bindValue(":user_id", userId);
+        deleteQuery->bindValue(":habit_id", habitId);
+        deleteQuery->bindValue(":year", date.year());
+        if (!exec(*deleteQuery)) {
+            qDebug() << "Error deleting habit completions:" << deleteQuery->lastError().text();
+            return false;
+        }
+        rowsAffected += deleteQuery->numRowsAffected();
+    } else {
+        const CompletionBitmap::YearSummary summary = bitmap.summary(date.year());
+        CachedQuery writeQuery = cachedQuery("INSERT OR REPLACE INTO habit_completion_bitmaps (user_id, habit_id, year, bits, "
+                                             "completed_days, longest_run, leading_run, trailing_run) "
+                                             "VALUES (:user_id, :habit_id, :year, :bits, "
+                                             ":completed_days, :longest_run, :leading_run, :trailing_run)");
+        writeQuery->bindValue(":user_id", userId);
+        writeQuery->bindValue(":habit_id", habitId);
+        writeQuery->bindValue(":year", date.year());
+        writeQuery->bindValue(":bits", bitmap.yearBlob(date.year()));
+        writeQuery->bindValue(":completed_days", summary.completedDays);
+        writeQuery->bindValue(":longest_run", summary.longestRun);
+        writeQuery->bindValue(":leading_run", summary.leadingRun);
+        writeQuery->bindValue(":trailing_run", summary.trailingRun);
+        if (!exec(*writeQuery)) {
+            qDebug() << "Error writing habit completions:" << writeQuery->lastError().text();
+            return false;
+        }
+        rowsAffected += writeQuery->numRowsAffected();
+    }
+
+    if (!refreshPerfectDays(userId, date.year())) {
+        return false;
+    }
+    return transaction.commit();
 }
 
 int DatabaseManager::getNextHabitId(int userId)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("getNextHabitId");
+    if (!openForUser(userId)) {
+        timer.fail();
         return 1;
     }
 
-    QSqlQuery query;
-    query.prepare("SELECT MAX(habit_id) + 1 FROM habits WHERE user_id = :user_id");
-    query.bindValue(":user_id", userId);
+    CachedQuery query = cachedQuery("SELECT MAX(habit_id) + 1 FROM habits WHERE user_id = :user_id");
+    query->bindValue(":user_id", userId);
 
-    if (query.exec() && query.next()) {
-        QVariant value = query.value(0);
+    if (exec(*query) && query->next()) {
+        timer.addRows(1);
+        QVariant value = query->value(0);
         return value.isNull() ? 1 : value.toInt();
     }
     return 1;
 }
 // Corrections pour saveMeal() - Gestion propre des mises à jour
-bool DatabaseManager::saveMeal(int userId, int dayOfWeek, const QString &name, const QString &time,
-                               int calories, const QString &imagePath,
-                               const QList<QPair<QString, QString>> &ingredients)
+bool DatabaseManager::saveMeal(int userId, int dayOfWeek, const MealPlanView::MealInfo &meal)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("saveMeal");
+    if (!openForUser(userId)) {
+        timer.fail();
+        return false;
+    }
+
+    Transaction transaction(*this);
+    if (!transaction.isActive()) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
     int mealId = -1;
 
     // Vérifier si le meal existe déjà
-    query.prepare("SELECT id FROM meals WHERE user_id = :user_id AND day_of_week = :day AND name = :name AND time = :time");
-    query.bindValue(":user_id", userId);
-    query.bindValue(":day", dayOfWeek);
-    query.bindValue(":name", name);
-    query.bindValue(":time", time);
+    CachedQuery findQuery = cachedQuery("SELECT id FROM meals WHERE user_id = :user_id AND day_of_week = :day AND name = :name AND time = :time");
+    findQuery->bindValue(":user_id", userId);
+    findQuery->bindValue(":day", dayOfWeek);
+    findQuery->bindValue(":name", meal.name);
+    findQuery->bindValue(":time", meal.time);
 
     bool mealExists = false;
-    if (query.exec() && query.next()) {
-        mealId = query.value(0).toInt();
+    if (exec(*findQuery) && findQuery->next()) {
+        mealId = findQuery->value(0).toInt();
         mealExists = true;
     }
+    findQuery->finish();
 
     if (mealExists) {
         // UPDATE du meal existant
-        query.prepare("UPDATE meals SET calories = :calories, image_path = :image WHERE id = :id");
-        query.bindValue(":calories", calories);
-        query.bindValue(":image", imagePath);
-        query.bindValue(":id", mealId);
-
-        if (!query.exec()) {
-            qDebug() << "Error updating meal:" << query.lastError().text();
+        CachedQuery updateQuery = cachedQuery("UPDATE meals SET calories = :calories, image_path = :image, "
+                                              "protein_g = :protein, carbs_g = :carbs, fat_g = :fat WHERE id = :id");
+        updateQuery->bindValue(":calories", meal.calories);
+        updateQuery->bindValue(":image", meal.image);
+        updateQuery->bindValue(":protein", meal.proteinGrams);
+        updateQuery->bindValue(":carbs", meal.carbsGrams);
+        updateQuery->bindValue(":fat", meal.fatGrams);
+        updateQuery->bindValue(":id", mealId);
+
+        if (!exec(*updateQuery)) {
+            qDebug() << "Error updating meal:" << updateQuery->lastError().text();
+            timer.fail();
             return false;
         }
+        timer.addRows(updateQuery->numRowsAffected());
     } else {
         // INSERT nouveau meal
-        query.prepare("INSERT INTO meals (user_id, day_of_week, name, time, calories, image_path) "
-                      "VALUES (:user_id, :day, :name, :time, :calories, :image)");
-        query.bindValue(":user_id", userId);
-        query.bindValue(":day", dayOfWeek);
-        query.bindValue(":name", name);
-        query.bindValue(":time", time);
-        query.bindValue(":calories", calories);
-        query.bindValue(":image", imagePath);
-
-        if (!query.exec()) {
-            qDebug() << "Error inserting meal:" << query.lastError().text();
+        CachedQuery insertQuery = cachedQuery("INSERT INTO meals (user_id, day_of_week, name, time, calories, image_path, "
+                                              "protein_g, carbs_g, fat_g) "
+                                              "VALUES (:user_id, :day, :name, :time, :calories, :image, :protein, :carbs, :fat)");
+        insertQuery->bindValue(":user_id", userId);
+        insertQuery->bindValue(":day", dayOfWeek);
+        insertQuery->bindValue(":name", meal.name);
+        insertQuery->bindValue(":time", meal.time);
+        insertQuery->bindValue(":calories", meal.calories);
+        insertQuery->bindValue(":image", meal.image);
+        insertQuery->bindValue(":protein", meal.proteinGrams);
+        insertQuery->bindValue(":carbs", meal.carbsGrams);
+        insertQuery->bindValue(":fat", meal.fatGrams);
+
+        if (!exec(*insertQuery)) {
+            qDebug() << "Error inserting meal:" << insertQuery->lastError().text();
+            timer.fail();
             return false;
         }
-        mealId = query.lastInsertId().toInt();
+        timer.addRows(insertQuery->numRowsAffected());
+        mealId = insertQuery->lastInsertId().toInt();
     }
 
     // Nettoyer les anciens ingrédients (même pour les nouveaux meals par sécurité)
-    query.prepare("DELETE FROM meal_ingredients WHERE meal_id = :meal_id");
-    query.bindValue(":meal_id", mealId);
-    if (!query.exec()) {
-        qDebug() << "Error clearing meal ingredients:" << query.lastError().text();
+    CachedQuery clearQuery = cachedQuery("DELETE FROM meal_ingredients WHERE meal_id = :meal_id");
+    clearQuery->bindValue(":meal_id", mealId);
+    if (!exec(*clearQuery)) {
+        qDebug() << "Error clearing meal ingredients:" << clearQuery->lastError().text();
+        timer.fail();
         return false;
     }
+    timer.addRows(clearQuery->numRowsAffected());
 
     // Sauvegarder les nouveaux ingrédients
-    for (const auto &ingredient : ingredients) {
-        query.prepare("INSERT INTO meal_ingredients (meal_id, ingredient_name, quantity) "
-                      "VALUES (:meal_id, :name, :quantity)");
-        query.bindValue(":meal_id", mealId);
-        query.bindValue(":name", ingredient.first);
-        query.bindValue(":quantity", ingredient.second);
-        if (!query.exec()) {
-            qDebug() << "Error saving meal ingredient:" << query.lastError().text();
+    CachedQuery ingredientQuery = cachedQuery("INSERT INTO meal_ingredients (meal_id, ingredient_name, quantity) "
+                                              "VALUES (:meal_id, :name, :quantity)");
+    for (const auto &ingredient : meal.ingredients) {
+        ingredientQuery->bindValue(":meal_id", mealId);
+        ingredientQuery->bindValue(":name", ingredient.first);
+        ingredientQuery->bindValue(":quantity", ingredient.second);
+        if (!exec(*ingredientQuery)) {
+            qDebug() << "Error saving meal ingredient:" << ingredientQuery->lastError().text();
+            timer.fail();
             return false;
         }
+        timer.addRows(ingredientQuery->numRowsAffected());
     }
-    return true;
+    return timer.check(transaction.commit());
 }
 
 bool DatabaseManager::loadMeals(int userId, QMap<int, QList<MealPlanView::MealInfo>> &meals)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("loadMeals");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
     meals.clear();
-    QSqlQuery mealQuery;
-    mealQuery.prepare("SELECT id, day_of_week, name, time, calories, image_path FROM meals WHERE user_id = :user_id");
-    mealQuery.bindValue(":user_id", userId);
-
-    if (mealQuery.exec()) {
-        while (mealQuery.next()) {
-            int mealId = mealQuery.value(0).toInt();
-            int dayOfWeek = mealQuery.value(1).toInt();
-            MealPlanView::MealInfo meal;
-            meal.name = mealQuery.value(2).toString();
-            meal.time = mealQuery.value(3).toString();
-            meal.calories = QString("%1 kcal").arg(mealQuery.value(4).toInt());
-            meal.image = mealQuery.value(5).toString();
-
-            // Load ingredients
-            QSqlQuery ingredientQuery;
-            ingredientQuery.prepare("SELECT ingredient_name, quantity FROM meal_ingredients WHERE meal_id = :meal_id");
-            ingredientQuery.bindValue(":meal_id", mealId);
-            if (ingredientQuery.exec()) {
-                while (ingredientQuery.next()) {
-                    meal.ingredients.append({ingredientQuery.value(0).toString(), ingredientQuery.value(1).toString()});
-                }
-            } else {
-                qDebug() << "Error loading meal ingredients:" << ingredientQuery.lastError().text();
-                return false;
-            }
 
-            meals[dayOfWeek].append(meal);
+    // Une seule requête pour les repas et leurs ingrédients : les lignes d'un même
+    // repas arrivent groupées (ORDER BY m.id), on assemble donc tout en une passe.
+    CachedQuery mealQuery = cachedQuery("SELECT m.id, m.day_of_week, m.name, m.time, m.calories, m.image_path, "
+                                        "mi.ingredient_name, mi.quantity, m.protein_g, m.carbs_g, m.fat_g "
+                                        "FROM meals m LEFT JOIN meal_ingredients mi ON mi.meal_id = m.id "
+                                        "WHERE m.user_id = :user_id "
+                                        "ORDER BY m.day_of_week, m.time, m.id, mi.id");
+    mealQuery->bindValue(":user_id", userId);
+
+    if (!exec(*mealQuery)) {
+        qDebug() << "Error loading meals:" << mealQuery->lastError().text();
+        timer.fail();
+        return false;
+    }
+
+    int currentMealId = -1;
+    MealPlanView::MealInfo *meal = nullptr;
+    while (mealQuery->next()) {
+        timer.addRows(1);
+        int mealId = mealQuery->value(0).toInt();
+        if (mealId != currentMealId) {
+            currentMealId = mealId;
+            QList<MealPlanView::MealInfo> &dayMeals = meals[mealQuery->value(1).toInt()];
+            dayMeals.append(MealPlanView::MealInfo());
+            meal = &dayMeals.last();
+            meal->name = mealQuery->value(2).toString();
+            meal->time = mealQuery->value(3).toString();
+            meal->calories = mealQuery->value(4).toInt();
+            meal->image = mealQuery->value(5).toString();
+            meal->proteinGrams = mealQuery->value(8).toInt();
+            meal->carbsGrams = mealQuery->value(9).toInt();
+            meal->fatGrams = mealQuery->value(10).toInt();
+        }
+
+        // LEFT JOIN : un repas sans ingrédient renvoie une ligne avec des colonnes NULL
+        if (!mealQuery->isNull(6)) {
+            meal->ingredients.append({mealQuery->value(6).toString(), mealQuery->value(7).toString()});
         }
-        return true;
     }
-    qDebug() << "Error loading meals:" << mealQuery.lastError().text();
-    return false;
+    return true;
 }
 
 bool DatabaseManager::saveExercise(int userId, int dayOfWeek, const QString &name,
                                    const QString &duration, int calories, bool completed)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("saveExercise");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
+    Transaction transaction(*this);
+    if (!transaction.isActive()) {
+        timer.fail();
+        return false;
+    }
 
     // Vérifier si l'exercice existe déjà
-    query.prepare("SELECT id FROM exercises WHERE user_id = :user_id AND day_of_week = :day AND name = :name");
-    query.bindValue(":user_id", userId);
-    query.bindValue(":day", dayOfWeek);
-    query.bindValue(":name", name);
+    CachedQuery findQuery = cachedQuery("SELECT id FROM exercises WHERE user_id = :user_id AND day_of_week = :day AND name = :name");
+    findQuery->bindValue(":user_id", userId);
+    findQuery->bindValue(":day", dayOfWeek);
+    findQuery->bindValue(":name", name);
+
+    int exerciseId = -1;
+    if (exec(*findQuery) && findQuery->next()) {
+        exerciseId = findQuery->value(0).toInt();
+    }
+    findQuery->finish();
 
-    if (query.exec() && query.next()) {
+    if (exerciseId != -1) {
         // UPDATE de l'exercice existant
-        int exerciseId = query.value(0).toInt();
-        query.prepare("UPDATE exercises SET duration = :duration, calories = :calories, completed = :completed WHERE id = :id");
-        query.bindValue(":duration", duration);
-        query.bindValue(":calories", calories);
-        query.bindValue(":completed", completed ? 1 : 0);
-        query.bindValue(":id", exerciseId);
+        CachedQuery updateQuery = cachedQuery("UPDATE exercises SET duration = :duration, calories = :calories, completed = :completed WHERE id = :id");
+        updateQuery->bindValue(":duration", duration);
+        updateQuery->bindValue(":calories", calories);
+        updateQuery->bindValue(":completed", completed ? 1 : 0);
+        updateQuery->bindValue(":id", exerciseId);
+
+        if (!exec(*updateQuery)) {
+            qDebug() << "Error saving exercise:" << updateQuery->lastError().text();
+            timer.fail();
+            return false;
+        }
+        timer.addRows(updateQuery->numRowsAffected());
     } else {
         // INSERT nouvel exercice
-        query.prepare("INSERT INTO exercises (user_id, day_of_week, name, duration, calories, completed) "
-                      "VALUES (:user_id, :day, :name, :duration, :calories, :completed)");
-        query.bindValue(":user_id", userId);
-        query.bindValue(":day", dayOfWeek);
-        query.bindValue(":name", name);
-        query.bindValue(":duration", duration);
-        query.bindValue(":calories", calories);
-        query.bindValue(":completed", completed ? 1 : 0);
-    }
-
-    if (!query.exec()) {
-        qDebug() << "Error saving exercise:" << query.lastError().text();
-        return false;
+        CachedQuery insertQuery = cachedQuery("INSERT INTO exercises (user_id, day_of_week, name, duration, calories, completed) "
+                                              "VALUES (:user_id, :day, :name, :duration, :calories, :completed)");
+        insertQuery->bindValue(":user_id", userId);
+        insertQuery->bindValue(":day", dayOfWeek);
+        insertQuery->bindValue(":name", name);
+        insertQuery->bindValue(":duration", duration);
+        insertQuery->bindValue(":calories", calories);
+        insertQuery->bindValue(":completed", completed ? 1 : 0);
+
+        if (!exec(*insertQuery)) {
+            qDebug() << "Error saving exercise:" << insertQuery->lastError().text();
+            timer.fail();
+            return false;
+        }
+        timer.addRows(insertQuery->numRowsAffected());
     }
-    return true;
+    return timer.check(transaction.commit());
 }
 
 bool DatabaseManager::loadExercises(int userId, QMap<int, QList<MealPlanView::ExerciseInfo>> &exercises)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("loadExercises");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
     exercises.clear();
-    QSqlQuery query;
-    query.prepare("SELECT day_of_week, name, duration, calories, completed FROM exercises WHERE user_id = :user_id");
-    query.bindValue(":user_id", userId);
+    CachedQuery query = cachedQuery("SELECT day_of_week, name, duration, calories, completed FROM exercises WHERE user_id = :user_id");
+    query->bindValue(":user_id", userId);
 
-    if (query.exec()) {
-        while (query.next()) {
-            int dayOfWeek = query.value(0).toInt();
+    if (exec(*query)) {
+        while (query->next()) {
+            timer.addRows(1);
+            int dayOfWeek = query->value(0).toInt();
             MealPlanView::ExerciseInfo exercise;
-            exercise.name = query.value(1).toString();
-            exercise.duration = query.value(2).toString();
-            exercise.calories = QString("%1 kcal").arg(query.value(3).toInt());
-            exercise.completed = query.value(4).toBool();
+            exercise.name = query->value(1).toString();
+            exercise.duration = query->value(2).toString();
+            exercise.calories = query->value(3).toInt();
+            exercise.completed = query->value(4).toBool();
             exercises[dayOfWeek].append(exercise);
         }
         return true;
     }
-    qDebug() << "Error loading exercises:" << query.lastError().text();
+    qDebug() << "Error loading exercises:" << query->lastError().text();
+    timer.fail();
     return false;
 }
 bool DatabaseManager::saveWaterData(int userId, const QString &date, int dailyGoal, int currentAmount)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("saveWaterData");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
-    query.prepare("INSERT OR REPLACE INTO water_intake (user_id, date, daily_goal, current_amount) "
-                  "VALUES (:user_id, :date, :daily_goal, :current_amount)");
-    query.bindValue(":user_id", userId);
-    query.bindValue(":date", date);
-    query.bindValue(":daily_goal", dailyGoal);
-    query.bindValue(":current_amount", currentAmount);
+    CachedQuery query = cachedQuery("INSERT OR REPLACE INTO water_intake (user_id, date, daily_goal, current_amount) "
+                                    "VALUES (:user_id, :date, :daily_goal, :current_amount)");
+    query->bindValue(":user_id", userId);
+    query->bindValue(":date", date);
+    query->bindValue(":daily_goal", dailyGoal);
+    query->bindValue(":current_amount", currentAmount);
 
-    if (!query.exec()) {
-        qDebug() << "Error saving water data:" << query.lastError().text();
+    if (!exec(*query)) {
+        qDebug() << "Error saving water data:" << query->lastError().text();
+        timer.fail();
         return false;
     }
+    timer.addRows(query->numRowsAffected());
     return true;
 }
 
 bool DatabaseManager::loadWaterData(int userId, const QString &date, int &dailyGoal, int &currentAmount)
 {
-    if (!isOpen() && !openDatabase()) {
+    QueryTimer timer("loadWaterData");
+    if (!openForUser(userId)) {
+        timer.fail();
         return false;
     }
 
-    QSqlQuery query;
-    query.prepare("SELECT daily_goal, current_amount FROM water_intake WHERE user_id = :user_id AND date = :date");
-    query.bindValue(":user_id", userId);
-    query.bindValue(":date", date);
+    CachedQuery query = cachedQuery("SELECT daily_goal, current_amount FROM water_intake WHERE user_id = :user_id AND date = :date");
+    query->bindValue(":user_id", userId);
+    query->bindValue(":date", date);
 
-    if (query.exec() && query.next()) {
-        dailyGoal = query.value(0).toInt();
-        currentAmount = query.value(1).toInt();
+    if (exec(*query) && query->next()) {
+        timer.addRows(1);
+        dailyGoal = query->value(0).toInt();
+        currentAmount = query->value(1).toInt();
         return true;
     }
     return false; // No data found for the user and date
@@ -853,15 +2147,26 @@ bool DatabaseManager::cleanupOrphanedData()
     if (!isOpen() && !openDatabase()) {
         return false;
     }
+    if (m_schemaRole == SchemaRole::Directory && m_attachedUserId == -1) {
+        return true; // Annuaire seul : pas de repas à nettoyer
+    }
 
-    QSqlQuery query;
+    QSqlQuery query(m_database);
 
     // Nettoyer les ingrédients orphelins
-    if (!query.exec("DELETE FROM meal_ingredients WHERE meal_id NOT IN (SELECT id FROM meals)")) {
+    if (!exec(query, "DELETE FROM meal_ingredients WHERE meal_id NOT IN (SELECT id FROM meals)")) {
         qDebug() << "Error cleaning orphaned ingredients:" << query.lastError().text();
         return false;
     }
 
+    // Nettoyer les bitmaps de complétion des habitudes supprimées
+    if (!exec(query, "DELETE FROM habit_completion_bitmaps WHERE NOT EXISTS ("
+                     "SELECT 1 FROM habits h WHERE h.user_id = habit_completion_bitmaps.user_id "
+                     "AND h.habit_id = habit_completion_bitmaps.habit_id)")) {
+        qDebug() << "Error cleaning orphaned habit completions:" << query.lastError().text();
+        return false;
+    }
+
     qDebug() << "Cleaned up orphaned data successfully";
     return true;
 }
@@ -869,18 +2174,18 @@ bool DatabaseManager::cleanupOrphanedData()
 // Fonction pour vérifier la cohérence des données
 bool DatabaseManager::verifyDataIntegrity(int userId)
 {
-    if (!isOpen() && !openDatabase()) {
+    if (!openForUser(userId)) {
         return false;
     }
 
-    QSqlQuery query;
+    QSqlQuery query(m_database);
 
     // Vérifier les meals sans ingrédients
     query.prepare("SELECT COUNT(*) FROM meals m WHERE m.user_id = :user_id AND "
                   "NOT EXISTS (SELECT 1 FROM meal_ingredients mi WHERE mi.meal_id = m.id)");
     query.bindValue(":user_id", userId);
 
-    if (query.exec() && query.next()) {
+    if (exec(query) && query.next()) {
         int mealsWithoutIngredients = query.value(0).toInt();
         if (mealsWithoutIngredients > 0) {
             qDebug() << "Warning: Found" << mealsWithoutIngredients << "meals without ingredients for user" << userId;
@@ -888,8 +2193,8 @@ bool DatabaseManager::verifyDataIntegrity(int userId)
     }
 
     // Vérifier les ingrédients orphelins
-    if (query.exec("SELECT COUNT(*) FROM meal_ingredients mi WHERE "
-                   "NOT EXISTS (SELECT 1 FROM meals m WHERE m.id = mi.meal_id)")) {
+    if (exec(query, "SELECT COUNT(*) FROM meal_ingredients mi WHERE "
+                    "NOT EXISTS (SELECT 1 FROM meals m WHERE m.id = mi.meal_id)")) {
         if (query.next()) {
             int orphanedIngredients = query.value(0).toInt();
             if (orphanedIngredients > 0) {
@@ -905,11 +2210,11 @@ bool DatabaseManager::verifyDataIntegrity(int userId)
 // Fonction pour récupérer les données de debug
 void DatabaseManager::debugMealData(int userId)
 {
-    if (!isOpen() && !openDatabase()) {
+    if (!openForUser(userId)) {
         return;
     }
 
-    QSqlQuery query;
+    QSqlQuery query(m_database);
 
     qDebug() << "=== DEBUG MEAL DATA FOR USER" << userId << "===";
 
@@ -917,7 +2222,7 @@ void DatabaseManager::debugMealData(int userId)
     query.prepare("SELECT id, day_of_week, name, time, calories FROM meals WHERE user_id = :user_id ORDER BY day_of_week, time");
     query.bindValue(":user_id", userId);
 
-    if (query.exec()) {
+    if (exec(query)) {
         while (query.next()) {
             int mealId = query.value(0).toInt();
             qDebug() << QString("Meal ID: %1, Day: %2, Name: %3, Time: %4, Calories: %5")
@@ -925,11 +2230,11 @@ void DatabaseManager::debugMealData(int userId)
                             .arg(query.value(3).toString()).arg(query.value(4).toInt());
 
             // Lister les ingrédients pour ce meal
-            QSqlQuery ingredientQuery;
+            QSqlQuery ingredientQuery(m_database);
             ingredientQuery.prepare("SELECT ingredient_name, quantity FROM meal_ingredients WHERE meal_id = :meal_id");
             ingredientQuery.bindValue(":meal_id", mealId);
 
-            if (ingredientQuery.exec()) {
+            if (exec(ingredientQuery)) {
                 while (ingredientQuery.next()) {
                     qDebug() << QString("  - %1: %2").arg(ingredientQuery.value(0).toString())
                     .arg(ingredientQuery.value(1).toString());
@@ -3,41 +3,160 @@
 
 #include <QObject>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QString>
 #include <QVariantMap>
+#include <QHash>
+#include <QSharedPointer>
 
 #include <QMap>
 #include <QSet>
 #include <QDate>
+#include <QDateTime>
 #include "MealPlanView.h"
-#include "HabitsView.h"
+#include "habit.h"
+#include "userinfo.h"
 class DatabaseManager : public QObject
 {
     Q_OBJECT
 public:
     static DatabaseManager& instance();
     ~DatabaseManager();
+
+    // Transaction RAII : BEGIN à la construction, ROLLBACK à la destruction si commit()
+    // n'a pas été appelé. Les transactions s'imbriquent : seule la plus externe
+    // exécute réellement le COMMIT, et un échec interne annule l'ensemble.
+    class Transaction
+    {
+    public:
+        explicit Transaction(DatabaseManager &manager);
+        ~Transaction();
+        bool commit();
+        bool isActive() const { return m_active; }
+
+    private:
+        Transaction(const Transaction&) = delete;
+        Transaction& operator=(const Transaction&) = delete;
+
+        DatabaseManager &m_manager;
+        bool m_active;
+    };
+
+    bool beginTransaction();
+    bool commitTransaction();
+    void rollbackTransaction();
+    bool inTransaction() const { return m_transactionDepth > 0; }
+
+    // Compteurs du cache de requêtes préparées (hit = requête réutilisée sans re-préparation)
+    struct StatementCacheStats
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        int cachedStatements = 0;
+    };
+    StatementCacheStats statementCacheStats() const;
+    void resetStatementCacheStats();
+
+    // Réglages SQLite appliqués à l'ouverture de la connexion (PRAGMA).
+    // Le profil par défaut est choisi via la variable d'environnement
+    // EFITNESS_STORAGE_PROFILE ("desktop", "kiosk" ou "benchmark").
+    struct StorageProfile
+    {
+        QString name;
+        QString journalMode = "WAL";     // DELETE, TRUNCATE, WAL...
+        QString synchronous = "NORMAL";  // OFF, NORMAL, FULL
+        int cacheSizeKiB = 8192;         // Taille du cache de pages
+        qint64 mmapSizeBytes = 0;        // 0 = pas de mmap
+        int busyTimeoutMs = 5000;        // Attente maximale sur un verrou
+
+        static StorageProfile desktop();
+        static StorageProfile kiosk();
+        static StorageProfile benchmark();
+        static StorageProfile fromName(const QString &name);
+    };
+    void setStorageProfile(const StorageProfile &profile);
+    StorageProfile storageProfile() const { return m_storageProfile; }
+
+    // Migrations du schéma (PRAGMA user_version) appliquées à l'ouverture,
+    // avec la durée de chacune pour le diagnostic
+    struct MigrationRecord
+    {
+        int version = 0;
+        QString description;
+        qint64 elapsedMs = 0;
+    };
+    int schemaVersion();
+    QList<MigrationRecord> appliedMigrations() const { return m_appliedMigrations; }
+
     bool cleanupOrphanedData();
     bool verifyDataIntegrity(int userId);
     void debugMealData(int userId);
     bool saveWaterData(int userId, const QString &date, int dailyGoal, int currentAmount);
     bool loadWaterData(int userId, const QString &date, int &dailyGoal, int &currentAmount);
-    bool saveMeal(int userId, int dayOfWeek, const QString &name, const QString &time, int calories, const QString &imagePath, const QList<QPair<QString, QString>> &ingredients);
+    bool saveMeal(int userId, int dayOfWeek, const MealPlanView::MealInfo &meal);
     bool loadMeals(int userId, QMap<int, QList<MealPlanView::MealInfo>> &meals);
     bool saveExercise(int userId, int dayOfWeek, const QString &name, const QString &duration, int calories, bool completed);
     bool loadExercises(int userId, QMap<int, QList<MealPlanView::ExerciseInfo>> &exercises);
 
+    // Journal d'entraînement en ajout seul (une ligne par série ou par séance).
+    // Les agrégats jour/semaine/mois sont tenus à jour par trigger à chaque insertion,
+    // la lecture d'une période est donc une recherche par clé primaire.
+    enum class WorkoutEventType { Set, Session };
+    enum class RollupPeriod { Day, Week, Month };
+    struct WorkoutEvent
+    {
+        WorkoutEventType type = WorkoutEventType::Set;
+        QString exerciseName;
+        QDateTime occurredAt;
+        int durationSeconds = 0;
+        int calories = 0;
+    };
+    struct WorkoutRollup
+    {
+        int sessions = 0;
+        int sets = 0;
+        int calories = 0;       // Somme des séances
+        int activeSeconds = 0;  // Somme des séances
+    };
+    bool recordWorkoutEvent(int userId, const WorkoutEvent &event);
+    bool loadWorkoutRollup(int userId, RollupPeriod period, const QDate &date, WorkoutRollup &rollup);
+
     bool updateUserStats(int userId, int workoutSessions, int caloriesBurned, int activityMinutes, int exercisesDone);
     bool loadUserStats(int userId, int &workoutSessions, int &caloriesBurned, int &activityMinutes, int &exercisesDone);
     bool saveUserGoals(int userId, const QMap<QString, int> &goals);
     bool loadUserGoals(int userId, QMap<QString, int> &goals);
-    bool saveHabit(int userId, int habitId, const QString &name, int goalDays, const QSet<QDate> &completedDates);
-    bool loadHabits(int userId, QMap<int, QMap<QString, QVariant>> &habits);
+    // Réécrit tout l'historique de l'habitude : completedDates doit être complet
+    bool saveHabit(int userId, int habitId, const QString &name, int goalDays, const CompletionBitmap &completedDates);
+    // Remplit directement les Habit (nom, objectif, dates) ; la série et completedToday
+    // restent à calculer par l'appelant. Seules les années >= fromYear sont chargées,
+    // les plus anciennes arrivent sous forme de résumés dans Habit::archivedYears.
+    bool loadHabits(int userId, QMap<int, Habit> &habits, int fromYear = 0);
+    bool loadHabitYear(int userId, int year, QMap<int, CompletionBitmap> &completions);
+    // Journées parfaites par année (< beforeYear), tenues à jour à chaque écriture
+    bool loadArchivedPerfectDays(int userId, int beforeYear, QMap<int, int> &perfectDays);
     bool deleteHabit(int userId, int habitId);
+    // Mise à jour incrémentale d'une seule date : seul le bitmap de son année est réécrit
+    bool addHabitCompletion(int userId, int habitId, const QDate &date);
+    bool removeHabitCompletion(int userId, int habitId, const QDate &date);
     int getNextHabitId(int userId);
 
     bool getUserInfo(const QString &email, QString &firstName, QString &lastName,
                      int &age, double &weight, double &height, QString &fitnessLevel);
+    // Dossier des données (~/.efitness, ou EFITNESS_DATA_DIR s'il est défini)
+    static QString dataDirectory();
+
+    // Disposition des fichiers, choisie par EFITNESS_STORAGE_LAYOUT :
+    // - SingleFile (défaut) : tout dans fitness_data.db ;
+    // - Sharded ("sharded") : annuaire directory.db (users, user_goals) et un fichier
+    //   users/user_<id>.db par utilisateur, attaché sous le nom "shard" à la connexion
+    //   de l'utilisateur (setCurrentUserId) ou au premier appel qui le concerne.
+    //   Sauvegarde et suppression des données d'un utilisateur = un fichier.
+    enum class StorageLayout { SingleFile, Sharded };
+    static StorageLayout storageLayout();
+    static QString userShardPath(int userId);
+    int attachedUserId() const { return m_attachedUserId; }
+    QString databasePath() const { return m_databasePath; }
+    QString connectionName() const { return m_connectionName; }
     bool openDatabase();
     void closeDatabase();
     bool isOpen() const;
@@ -46,31 +165,91 @@ public:
                     const QString &email, const QString &password,
                     int age, double weight, double height,
                     const QString &fitnessLevel);
+    // Variante pour un hachage PasswordHasher déjà calculé hors du thread base de données
+    bool createUserWithHash(const QString &firstName, const QString &lastName,
+                            const QString &email, const QString &passwordHash,
+                            int age, double weight, double height,
+                            const QString &fitnessLevel);
     bool checkCredentials(const QString &email, const QString &password);
     int getUserId(const QString &email); // Récupère l'ID basé sur l'email
+    // Connexion en une seule requête : remplit userInfo (profil, statistiques et
+    // objectifs) et renvoie le hachage stocké, à vérifier hors du thread GUI avec
+    // PasswordHasher. Retourne false si l'email est inconnu.
+    bool loadSession(const QString &email, UserInfo &userInfo, QString &passwordHash);
+    bool updatePasswordHash(int userId, const QString &passwordHash);
 
     // Nouvelles méthodes pour gérer l'utilisateur courant
     void setCurrentUserId(int userId); // Pour définir l'utilisateur après connexion
+    // Utilisateur dont le fichier est attaché avant chaque transaction (Sharded), commun
+    // à toutes les connexions ; n'ouvre aucune connexion
+    static void setActiveShardUser(int userId);
     int getCurrentUserId() const;      // Pour que DashboardWindow le récupère
 
     // Méthode pour récupérer toutes les données utilisateur utiles pour Dashboard
     // Retourne un QVariantMap pour la flexibilité, ou vous pourriez créer une struct UserData
     QVariantMap getUserData(int userId);
-    explicit DatabaseManager(QObject *parent = nullptr);
+    enum OpenMode { ReadWrite, ReadOnly };
+
+    // Sans nom : connexion par défaut (singleton du thread GUI). Un nom distinct
+    // est nécessaire pour chaque thread qui ouvre sa propre connexion.
+    // En ReadOnly, le schéma n'est pas créé et toute écriture échoue.
+    explicit DatabaseManager(const QString &connectionName = QString(), OpenMode mode = ReadWrite,
+                             QObject *parent = nullptr);
+    bool isReadOnly() const { return m_openMode == ReadOnly; }
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
     QString getUserName(int userId);
     QString getUserPlanType(int userId);
 
 private:
+    // Requête préparée issue du cache. Elle est remise à zéro (finish) à la sortie
+    // de la portée pour libérer les verrous de lecture SQLite.
+    class CachedQuery
+    {
+    public:
+        explicit CachedQuery(const QSharedPointer<QSqlQuery> &query) : m_query(query) {}
+        ~CachedQuery() { m_query->finish(); }
+        QSqlQuery *operator->() const { return m_query.data(); }
+        QSqlQuery &operator*() const { return *m_query; }
+
+    private:
+        QSharedPointer<QSqlQuery> m_query;
+    };
+
+    CachedQuery cachedQuery(const QString &sql);
+    // Exécution chronométrée : au-delà du seuil, la requête part dans SlowQueryLog
+    bool exec(QSqlQuery &query);
+    bool exec(QSqlQuery &query, const QString &sql);
+    void clearStatementCache();
+
+    // Directory : annuaire d'une disposition Sharded ; Full : base unique ou fichier utilisateur
+    enum class SchemaRole { Full, Directory };
 
+    bool openForUser(int userId); // Ouvre la connexion et attache le fichier de l'utilisateur
+    bool updateHabitCompletion(int userId, int habitId, const QDate &date, bool completed, qint64 &rowsAffected);
+    bool refreshPerfectDays(int userId, int year = 0); // 0 : toutes les années
+    bool attachUserShard(int userId);
+    static bool initializeUserShard(int userId);
 
+    bool createDirectoryTables();
     bool createTables();
+    bool migrateSchema();
+    bool applyStorageProfile();
 
     QSqlDatabase m_database;
+    QString m_connectionName;
+    OpenMode m_openMode;
+    SchemaRole m_schemaRole;
+    QHash<QString, QSharedPointer<QSqlQuery>> m_statementCache; // Clé : texte SQL
+    StatementCacheStats m_statementCacheStats;
+    StorageProfile m_storageProfile;
+    QList<MigrationRecord> m_appliedMigrations;
     QString m_databasePath;
     bool m_isInitialized;
     int m_currentLoggedInUserId; // Pour stocker l'ID de l'utilisateur connecté
+    int m_transactionDepth;      // Profondeur des transactions imbriquées
+    bool m_transactionFailed;    // Une transaction interne a échoué : ROLLBACK au niveau externe
+    int m_attachedUserId;        // Fichier utilisateur attaché (Sharded), -1 sinon
 };
 
 #endif // DATABASEMANAGER_H
@@ -0,0 +1,25 @@
+#ifndef HABIT_H
+#define HABIT_H
+
+#include <QString>
+#include <QDate>
+#include <QMap>
+#include "completionbitmap.h"
+
+// Une habitude et son historique, telle que chargée par DatabaseManager::loadHabits
+// et affichée par HabitsView.
+struct Habit
+{
+    QString name;
+    int currentStreak;
+    int goalDays;
+    CompletionBitmap completedDates;
+    // Années antérieures à la fenêtre chargée : résumés seulement (chargement paresseux)
+    QMap<int, CompletionBitmap::YearSummary> archivedYears;
+    bool completedToday;
+
+    Habit() : currentStreak(0), goalDays(30), completedToday(false) {}
+    Habit(const QString &n, int goal = 30) : name(n), currentStreak(0), goalDays(goal), completedToday(false) {}
+};
+
+#endif // HABIT_H
@@ -0,0 +1,257 @@
+#include "habitheatmap.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QLocale>
+
+namespace {
+constexpr int kGap = 2;        // Espace entre deux cases
+constexpr int kMonthRows = 6;  // Semaines d'une page mensuelle (hauteur constante d'un mois à l'autre)
+
+// Palette GitHub : aucune complétion, puis ratio < 50 %, < 70 %, < 90 %, >= 90 %
+const QColor &levelColor(int level)
+{
+    static const QColor colors[] = {QColor("#ebedf0"), QColor("#c6e48b"), QColor("#7bc96f"),
+                                    QColor("#239a3b"), QColor("#196127")};
+    return colors[level];
+}
+}
+
+HabitHeatmap::HabitHeatmap(QWidget *parent)
+    : QWidget(parent), m_year(QDate::currentDate().year()), m_month(QDate::currentDate().month()),
+      m_selectedDate(QDate::currentDate())
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    updateGeometryCache();
+}
+
+void HabitHeatmap::setMode(Mode mode)
+{
+    if (mode == m_mode) {
+        return;
+    }
+    m_mode = mode;
+    updateGeometryCache();
+    updateGeometry();
+    update();
+}
+
+void HabitHeatmap::setCurrentPage(int year, int month)
+{
+    if (year == m_year && month == m_month) {
+        return;
+    }
+    m_year = year;
+    m_month = month;
+    updateGeometryCache();
+    update();
+    emit currentPageChanged(year, month);
+}
+
+void HabitHeatmap::showPreviousPage()
+{
+    const QDate first(m_year, m_month, 1);
+    const QDate previous = (m_mode == Mode::Month) ? first.addMonths(-1) : first.addYears(-1);
+    setCurrentPage(previous.year(), previous.month());
+}
+
+void HabitHeatmap::showNextPage()
+{
+    const QDate first(m_year, m_month, 1);
+    const QDate next = (m_mode == Mode::Month) ? first.addMonths(1) : first.addYears(1);
+    setCurrentPage(next.year(), next.month());
+}
+
+void HabitHeatmap::setSelectedDate(const QDate &date)
+{
+    if (date == m_selectedDate) {
+        return;
+    }
+    // Ancienne et nouvelle case seulement
+    update(cellRect(m_selectedDate));
+    m_selectedDate = date;
+    update(cellRect(m_selectedDate));
+}
+
+void HabitHeatmap::setRatios(int year, const QVector<float> &ratios)
+{
+    m_ratioYear = year;
+    m_ratios = ratios;
+    update();
+}
+
+void HabitHeatmap::setRatio(const QDate &date, float ratio)
+{
+    const int index = date.dayOfYear() - 1;
+    if (date.year() != m_ratioYear || index >= m_ratios.size() || m_ratios.at(index) == ratio) {
+        return;
+    }
+    m_ratios[index] = ratio;
+    update(cellRect(date));
+}
+
+QSize HabitHeatmap::sizeHint() const
+{
+    return (m_mode == Mode::Month) ? QSize(300, 240) : QSize(720, 130);
+}
+
+void HabitHeatmap::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+    const QLocale locale;
+
+    // En-têtes : jours de la semaine (Month) ou mois et lundi/mercredi/vendredi (Year)
+    painter.setPen(QColor("#6c757d"));
+    if (dirty.top() < m_origin.y() || (m_mode == Mode::Year && dirty.left() < m_origin.x())) {
+        QFont headerFont = font();
+        if (headerFont.pointSizeF() > 0) {
+            headerFont.setPointSizeF(headerFont.pointSizeF() * 0.85);
+        }
+        painter.setFont(headerFont);
+        const int headerHeight = m_origin.y();
+        if (m_mode == Mode::Month) {
+            for (int day = 1; day <= 7; ++day) {
+                const QRect header(m_origin.x() + (day - 1) * m_cellSize, 0, m_cellSize - kGap, headerHeight);
+                painter.drawText(header, Qt::AlignCenter, locale.dayName(day, QLocale::ShortFormat));
+            }
+        } else {
+            for (int month = 1; month <= 12; ++month) {
+                const int column = int(m_gridStart.daysTo(QDate(m_year, month, 1)) / 7);
+                const QRect header(m_origin.x() + column * m_cellSize, 0, 4 * m_cellSize, headerHeight);
+                painter.drawText(header, Qt::AlignLeft | Qt::AlignVCenter, locale.monthName(month, QLocale::ShortFormat));
+            }
+            for (int day = 1; day <= 5; day += 2) { // Lundi, mercredi, vendredi
+                const QRect header(0, m_origin.y() + (day - 1) * m_cellSize, m_origin.x() - kGap, m_cellSize);
+                painter.drawText(header, Qt::AlignLeft | Qt::AlignVCenter, locale.dayName(day, QLocale::ShortFormat));
+            }
+        }
+        painter.setFont(font());
+    }
+
+    // Cases : seules celles qui touchent la zone à redessiner
+    const QDate today = QDate::currentDate();
+    QFont todayFont = font();
+    todayFont.setBold(true);
+    for (QDate date = m_firstShown; date <= m_lastShown; date = date.addDays(1)) {
+        const QRect cell = cellRect(date);
+        if (!cell.intersects(dirty)) {
+            continue;
+        }
+        const int level = levelFor(date);
+        painter.fillRect(cell, levelColor(level));
+
+        if (m_mode == Mode::Month) {
+            painter.setPen(level >= 3 ? Qt::white : QColor("#333333"));
+            painter.setFont(date == today ? todayFont : font());
+            painter.drawText(cell, Qt::AlignCenter, QString::number(date.day()));
+        }
+        if (date == m_selectedDate) {
+            painter.setPen(QPen(QColor("#333333"), 2));
+            painter.setBrush(Qt::NoBrush);
+            painter.drawRect(cell.adjusted(1, 1, -1, -1));
+        }
+    }
+}
+
+void HabitHeatmap::mousePressEvent(QMouseEvent *event)
+{
+    const QDate date = dateAt(event->position().toPoint());
+    if (!date.isValid() || event->button() != Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    const bool changed = date != m_selectedDate;
+    setSelectedDate(date);
+    if (changed) {
+        emit selectionChanged();
+    }
+}
+
+void HabitHeatmap::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateGeometryCache();
+}
+
+void HabitHeatmap::updateGeometryCache()
+{
+    const int headerHeight = fontMetrics().height() + 4;
+    if (m_mode == Mode::Month) {
+        m_firstShown = QDate(m_year, m_month, 1);
+        m_lastShown = m_firstShown.addDays(m_firstShown.daysInMonth() - 1);
+        m_gridStart = m_firstShown.addDays(1 - m_firstShown.dayOfWeek());
+
+        m_cellSize = qMax(kGap + 1, qMin(width() / 7, (height() - headerHeight) / kMonthRows));
+        m_origin = QPoint((width() - 7 * m_cellSize) / 2, headerHeight);
+    } else {
+        m_firstShown = QDate(m_year, 1, 1);
+        m_lastShown = QDate(m_year, 12, 31);
+        m_gridStart = m_firstShown.addDays(1 - m_firstShown.dayOfWeek()); // Lundi de la première semaine
+
+        const int weeks = int(m_gridStart.daysTo(m_lastShown) / 7) + 1;
+        const int labelWidth = fontMetrics().horizontalAdvance(QLocale().dayName(3, QLocale::ShortFormat)) + 6;
+        m_cellSize = qMax(kGap + 1, qMin((width() - labelWidth) / weeks, (height() - headerHeight) / 7));
+        m_origin = QPoint(labelWidth, headerHeight);
+    }
+}
+
+QRect HabitHeatmap::cellRect(const QDate &date) const
+{
+    if (!date.isValid() || date < m_firstShown || date > m_lastShown) {
+        return QRect();
+    }
+    const int index = int(m_gridStart.daysTo(date));
+    // Month : les semaines sont des lignes ; Year : des colonnes
+    const int column = (m_mode == Mode::Month) ? index % 7 : index / 7;
+    const int row = (m_mode == Mode::Month) ? index / 7 : index % 7;
+    return QRect(m_origin.x() + column * m_cellSize, m_origin.y() + row * m_cellSize,
+                 m_cellSize - kGap, m_cellSize - kGap);
+}
+
+QDate HabitHeatmap::dateAt(const QPoint &position) const
+{
+    const QPoint offset = position - m_origin;
+    if (offset.x() < 0 || offset.y() < 0 || m_cellSize <= 0) {
+        return QDate();
+    }
+    const int column = offset.x() / m_cellSize;
+    const int row = offset.y() / m_cellSize;
+    if (offset.x() % m_cellSize >= m_cellSize - kGap || offset.y() % m_cellSize >= m_cellSize - kGap) {
+        return QDate(); // Dans l'espace entre deux cases
+    }
+
+    int index;
+    if (m_mode == Mode::Month) {
+        if (column >= 7 || row >= kMonthRows) {
+            return QDate();
+        }
+        index = row * 7 + column;
+    } else {
+        if (row >= 7) {
+            return QDate();
+        }
+        index = column * 7 + row;
+    }
+    const QDate date = m_gridStart.addDays(index);
+    return (date >= m_firstShown && date <= m_lastShown) ? date : QDate();
+}
+
+int HabitHeatmap::levelFor(const QDate &date) const
+{
+    const int index = date.dayOfYear() - 1;
+    if (date.year() != m_ratioYear || index >= m_ratios.size()) {
+        return 0;
+    }
+    const float ratio = m_ratios.at(index);
+    if (ratio <= 0.0f) {
+        return 0;
+    } else if (ratio < 0.5f) {
+        return 1;
+    } else if (ratio < 0.7f) {
+        return 2;
+    } else if (ratio < 0.9f) {
+        return 3;
+    }
+    return 4;
+}
@@ -0,0 +1,74 @@
+#ifndef HABITHEATMAP_H
+#define HABITHEATMAP_H
+
+#include <QWidget>
+#include <QDate>
+#include <QRect>
+#include <QVector>
+
+// Carte de chaleur des habitudes, dessinée à la main (remplace le formatage
+// date par date de QCalendarWidget). Deux vues :
+// - Month : grille du mois affiché, une case par jour avec son numéro ;
+// - Year : style GitHub, une colonne par semaine et une ligne par jour de la semaine.
+// Les couleurs viennent d'un tableau de ratios (habitudes validées / habitudes)
+// précalculé pour l'année affichée : le dessin ne dépend pas du nombre
+// d'habitudes. setRatio() et la sélection ne redessinent que les cases touchées.
+class HabitHeatmap : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum class Mode { Month, Year };
+
+    explicit HabitHeatmap(QWidget *parent = nullptr);
+
+    Mode mode() const { return m_mode; }
+    void setMode(Mode mode);
+    int yearShown() const { return m_year; }
+    int monthShown() const { return m_month; }
+    void setCurrentPage(int year, int month);
+    QDate selectedDate() const { return m_selectedDate; }
+    void setSelectedDate(const QDate &date);
+
+    // ratios[i] : ratio du jour i + 1 de l'année (0 à 1), pour toute l'année
+    void setRatios(int year, const QVector<float> &ratios);
+    void setRatio(const QDate &date, float ratio); // Redessine la seule case concernée
+
+    QSize sizeHint() const override;
+
+public slots:
+    void showPreviousPage(); // Mois précédent, ou année précédente en vue Year
+    void showNextPage();
+
+signals:
+    void currentPageChanged(int year, int month);
+    void selectionChanged();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void updateGeometryCache();
+    QRect cellRect(const QDate &date) const; // Vide si la date n'est pas affichée
+    QDate dateAt(const QPoint &position) const;
+    int levelFor(const QDate &date) const;   // 0 (rien) à 4 (presque tout validé)
+
+    Mode m_mode = Mode::Month;
+    int m_year;
+    int m_month;
+    QDate m_selectedDate;
+
+    int m_ratioYear = 0;
+    QVector<float> m_ratios;
+
+    // Géométrie de la page courante, recalculée au redimensionnement et au changement de page
+    QDate m_gridStart;   // Date de la première case (lundi), éventuellement hors page
+    QDate m_firstShown;  // Dates dessinées : le mois ou l'année affichés
+    QDate m_lastShown;
+    QPoint m_origin;     // Coin de la première case
+    int m_cellSize = 0;  // Pas de la grille (case + espacement)
+};
+
+#endif // HABITHEATMAP_H
@@ -0,0 +1,433 @@
+// Comportement de CompletionBitmap, CompletionRuns et HabitStatistics comparé au
+// parcours d'origine sur un QSet<QDate> (un contains() par jour, en remontant le temps).
+// Cas limites : passage 31 décembre -> 1er janvier, 29 février, année vide entre deux
+// années validées, années complètes, et chargement partiel (années archivées).
+#include <QtTest>
+#include <QSet>
+#include <QRandomGenerator>
+#include <algorithm>
+#include "completionbitmap.h"
+#include "completionruns.h"
+#include "habitstatistics.h"
+
+namespace {
+using DateSet = QSet<QDate>;
+
+const QDate kFirstDay(2020, 12, 1); // Plage vérifiée jour par jour
+const QDate kLastDay(2026, 1, 31);
+
+DateSet dateRange(const QDate &from, const QDate &to)
+{
+    DateSet dates;
+    for (QDate date = from; date <= to; date = date.addDays(1)) {
+        dates.insert(date);
+    }
+    return dates;
+}
+
+QMap<QString, DateSet> scenarios()
+{
+    QMap<QString, DateSet> result;
+    result["empty"] = DateSet();
+    result["dec31_jan1"] = dateRange(QDate(2023, 12, 25), QDate(2024, 1, 5));
+
+    DateSet leapDay = dateRange(QDate(2024, 2, 27), QDate(2024, 3, 2));
+    leapDay.insert(QDate(2023, 2, 28));
+    leapDay.insert(QDate(2023, 3, 1));
+    result["feb29"] = leapDay;
+
+    result["full_leap_year"] = dateRange(QDate(2024, 1, 1), QDate(2024, 12, 31));
+    result["full_years"] = dateRange(QDate(2022, 1, 1), QDate(2023, 12, 31));
+
+    // 2022 sans aucun jour : la série du 31/12/2021 ne rejoint pas celle de 2023
+    DateSet gap = dateRange(QDate(2021, 12, 20), QDate(2021, 12, 31));
+    gap.unite(dateRange(QDate(2023, 1, 1), QDate(2023, 1, 10)));
+    result["empty_year_between"] = gap;
+
+    QRandomGenerator rng(20240229);
+    DateSet random;
+    bool done = false;
+    for (QDate date(2021, 1, 1); date <= QDate(2025, 12, 31); date = date.addDays(1)) {
+        if (rng.bounded(4) == 0) {
+            done = !done;
+        }
+        if (done) {
+            random.insert(date);
+        }
+    }
+    result["random"] = random;
+    return result;
+}
+
+CompletionBitmap bitmapFrom(const DateSet &dates)
+{
+    CompletionBitmap bitmap;
+    for (const QDate &date : dates) {
+        bitmap.insert(date);
+    }
+    return bitmap;
+}
+
+QList<QDate> sorted(const DateSet &dates)
+{
+    QList<QDate> list = dates.values();
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
+// Références : le parcours jour par jour d'avant les bitmaps
+int refStreakEndingAt(const DateSet &dates, QDate date)
+{
+    int streak = 0;
+    while (dates.contains(date)) {
+        streak++;
+        date = date.addDays(-1);
+    }
+    return streak;
+}
+
+int refRunLength(const DateSet &dates, const QDate &date)
+{
+    if (!dates.contains(date)) {
+        return 0;
+    }
+    QDate end = date;
+    while (dates.contains(end.addDays(1))) {
+        end = end.addDays(1);
+    }
+    return refStreakEndingAt(dates, end);
+}
+
+int refLongest(const DateSet &dates)
+{
+    int longest = 0;
+    for (const QDate &date : dates) {
+        if (!dates.contains(date.addDays(1))) {
+            longest = qMax(longest, refStreakEndingAt(dates, date));
+        }
+    }
+    return longest;
+}
+
+int refRunCount(const DateSet &dates)
+{
+    int runs = 0;
+    for (const QDate &date : dates) {
+        runs += dates.contains(date.addDays(1)) ? 0 : 1;
+    }
+    return runs;
+}
+
+int refCount(const DateSet &dates, const QDate &from, const QDate &to)
+{
+    int count = 0;
+    for (QDate date = from; date <= to; date = date.addDays(1)) {
+        count += dates.contains(date) ? 1 : 0;
+    }
+    return count;
+}
+
+int refCurrentStreak(const DateSet &dates, const QDate &today)
+{
+    const int streak = refStreakEndingAt(dates, today);
+    return streak > 0 ? streak : refStreakEndingAt(dates, today.addDays(-1));
+}
+
+CompletionBitmap::YearSummary refSummary(const DateSet &dates, int year)
+{
+    CompletionBitmap::YearSummary summary;
+    int run = 0;
+    bool leading = true;
+    for (QDate date(year, 1, 1); date.year() == year; date = date.addDays(1)) {
+        if (dates.contains(date)) {
+            summary.completedDays++;
+            run++;
+            summary.longestRun = qMax(summary.longestRun, run);
+            summary.leadingRun += leading ? 1 : 0;
+        } else {
+            run = 0;
+            leading = false;
+        }
+    }
+    summary.trailingRun = run;
+    return summary;
+}
+
+void compareRuns(const CompletionRuns &runs, const DateSet &dates)
+{
+    QCOMPARE(runs.longest(), refLongest(dates));
+    QCOMPARE(runs.runCount(), refRunCount(dates));
+    for (QDate date = kFirstDay; date <= kLastDay; date = date.addDays(1)) {
+        QCOMPARE(runs.streakAt(date), refStreakEndingAt(dates, date));
+        QCOMPARE(runs.runLength(date), refRunLength(dates, date));
+    }
+}
+}
+
+class HabitHistoryTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void bitmapMatchesDateSet_data();
+    void bitmapMatchesDateSet();
+    void runsMatchDateSet_data();
+    void runsMatchDateSet();
+    void intersectionAndUnion();
+    void statisticsMatchDateSet_data();
+    void statisticsMatchDateSet();
+    void statisticsFollowToggles();
+};
+
+void HabitHistoryTest::bitmapMatchesDateSet_data()
+{
+    QTest::addColumn<QString>("scenario");
+    const QMap<QString, DateSet> all = scenarios();
+    for (auto it = all.constBegin(); it != all.constEnd(); ++it) {
+        QTest::newRow(qPrintable(it.key())) << it.key();
+    }
+}
+
+void HabitHistoryTest::bitmapMatchesDateSet()
+{
+    QFETCH(QString, scenario);
+    const DateSet dates = scenarios().value(scenario);
+    const CompletionBitmap bitmap = bitmapFrom(dates);
+
+    QCOMPARE(bitmap.isEmpty(), dates.isEmpty());
+    QCOMPARE(bitmap.count(), int(dates.size()));
+    QCOMPARE(bitmap.dates(), sorted(dates));
+    for (QDate date = kFirstDay; date <= kLastDay; date = date.addDays(1)) {
+        QCOMPARE(bitmap.contains(date), dates.contains(date));
+        QCOMPARE(bitmap.streakEndingAt(date), refStreakEndingAt(dates, date));
+    }
+
+    for (int year = kFirstDay.year(); year <= kLastDay.year(); ++year) {
+        QCOMPARE(bitmap.count(QDate(year, 1, 1), QDate(year, 12, 31)),
+                 refCount(dates, QDate(year, 1, 1), QDate(year, 12, 31)));
+        QCOMPARE(bitmap.count(QDate(year, 2, 20), QDate(year, 3, 5)),
+                 refCount(dates, QDate(year, 2, 20), QDate(year, 3, 5)));
+
+        const CompletionBitmap::YearSummary summary = bitmap.summary(year);
+        const CompletionBitmap::YearSummary expected = refSummary(dates, year);
+        QCOMPARE(summary.completedDays, expected.completedDays);
+        QCOMPARE(summary.longestRun, expected.longestRun);
+        QCOMPARE(summary.leadingRun, expected.leadingRun);
+        QCOMPARE(summary.trailingRun, expected.trailingRun);
+    }
+    QCOMPARE(bitmap.count(QDate(2023, 12, 30), QDate(2024, 1, 2)),
+             refCount(dates, QDate(2023, 12, 30), QDate(2024, 1, 2)));
+
+    // Forme persistée : une ligne par année non vide, relue à l'identique
+    CompletionBitmap restored;
+    for (int year : bitmap.years()) {
+        QVERIFY(refCount(dates, QDate(year, 1, 1), QDate(year, 12, 31)) > 0);
+        QCOMPARE(int(bitmap.yearBlob(year).size()), CompletionBitmap::kBlobBytes);
+        restored.setYearBlob(year, bitmap.yearBlob(year));
+    }
+    QCOMPARE(restored.dates(), sorted(dates));
+}
+
+void HabitHistoryTest::runsMatchDateSet_data()
+{
+    bitmapMatchesDateSet_data();
+}
+
+void HabitHistoryTest::runsMatchDateSet()
+{
+    QFETCH(QString, scenario);
+    const DateSet dates = scenarios().value(scenario);
+
+    compareRuns(CompletionRuns::fromBitmap(bitmapFrom(dates)), dates);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // Mises à jour incrémentales : insertions dans le désordre, puis un retrait sur trois
+    QList<QDate> order = dates.values();
+    QRandomGenerator rng(7);
+    std::shuffle(order.begin(), order.end(), rng);
+    CompletionRuns runs;
+    CompletionBitmap bitmap;
+    for (const QDate &date : order) {
+        runs.insert(date);
+        bitmap.insert(date);
+    }
+    compareRuns(runs, dates);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    DateSet remaining = dates;
+    for (int i = 0; i < order.size(); i += 3) {
+        runs.remove(order.at(i));
+        bitmap.remove(order.at(i));
+        remaining.remove(order.at(i));
+    }
+    compareRuns(runs, remaining);
+    QCOMPARE(bitmap.dates(), sorted(remaining));
+}
+
+void HabitHistoryTest::intersectionAndUnion()
+{
+    const QMap<QString, DateSet> all = scenarios();
+    for (auto a = all.constBegin(); a != all.constEnd(); ++a) {
+        for (auto b = all.constBegin(); b != all.constEnd(); ++b) {
+            const CompletionBitmap left = bitmapFrom(a.value());
+            const CompletionBitmap right = bitmapFrom(b.value());
+
+            DateSet intersection = a.value();
+            intersection.intersect(b.value());
+            QCOMPARE(left.intersected(right).dates(), sorted(intersection));
+
+            DateSet united = a.value();
+            united.unite(b.value());
+            CompletionBitmap merged = left;
+            merged.unite(right);
+            QCOMPARE(merged.dates(), sorted(united));
+        }
+    }
+}
+
+void HabitHistoryTest::statisticsMatchDateSet_data()
+{
+    QTest::addColumn<QStringList>("habitNames");
+    QTest::newRow("boundaries") << QStringList{"dec31_jan1", "feb29", "full_leap_year"};
+    QTest::newRow("full_years") << QStringList{"full_years", "random"};
+    QTest::newRow("empty_habits") << QStringList{"random", "empty_year_between", "empty"};
+    QTest::newRow("same_history") << QStringList{"random", "random"};
+    QTest::newRow("single") << QStringList{"full_years"};
+}
+
+void HabitHistoryTest::statisticsMatchDateSet()
+{
+    QFETCH(QStringList, habitNames);
+    const QMap<QString, DateSet> all = scenarios();
+    QList<DateSet> histories;
+    for (const QString &name : habitNames) {
+        histories << all.value(name);
+    }
+
+    DateSet perfect = histories.first();
+    for (const DateSet &history : histories) {
+        perfect.intersect(history);
+    }
+
+    const QList<QDate> todays = {QDate(2022, 1, 1), QDate(2023, 1, 1), QDate(2023, 12, 31), QDate(2024, 1, 1),
+                                 QDate(2024, 1, 2), QDate(2024, 2, 29), QDate(2024, 3, 1), QDate(2025, 1, 1)};
+    for (const QDate &today : todays) {
+        // 0 : tout l'historique chargé ; sinon années >= fromYear, les autres en résumés
+        for (int fromYear : {0, 2022, 2023, 2024, 2025}) {
+            if (fromYear > today.year()) {
+                continue;
+            }
+            const QDate loadedFrom = fromYear > 0 ? QDate(fromYear, 1, 1) : QDate();
+
+            QMap<int, Habit> habits;
+            for (int i = 0; i < histories.size(); ++i) {
+                Habit habit(habitNames.at(i));
+                for (const QDate &date : histories.at(i)) {
+                    if (!loadedFrom.isValid() || date >= loadedFrom) {
+                        habit.completedDates.insert(date);
+                    }
+                }
+                if (loadedFrom.isValid()) {
+                    const CompletionBitmap full = bitmapFrom(histories.at(i));
+                    for (int year : full.years()) {
+                        if (year < fromYear) {
+                            habit.archivedYears.insert(year, full.summary(year));
+                        }
+                    }
+                }
+                habits.insert(i + 1, habit);
+            }
+            const int archivedPerfectDays = loadedFrom.isValid() ? refCount(perfect, kFirstDay, loadedFrom.addDays(-1)) : 0;
+
+            HabitStatistics statistics;
+            statistics.reset(habits, today, fromYear, archivedPerfectDays);
+
+            const QByteArray context = QString("today %1, from %2").arg(today.toString(Qt::ISODate)).arg(fromYear).toUtf8();
+            int longestEver = 0;
+            for (int i = 0; i < histories.size(); ++i) {
+                QVERIFY2(statistics.currentStreak(i + 1) == refCurrentStreak(histories.at(i), today), context.constData());
+                QVERIFY2(statistics.longestStreak(i + 1) == refLongest(histories.at(i)), context.constData());
+                longestEver = qMax(longestEver, refLongest(histories.at(i)));
+            }
+            QVERIFY2(statistics.longestStreakEver() == longestEver, context.constData());
+            QVERIFY2(statistics.perfectDays() == int(perfect.size()), context.constData());
+
+            // HabitsView charge toujours au moins le mois précédent : la fenêtre est détaillée
+            const QDate windowStart = today.addDays(1 - HabitStatistics::kWindowDays);
+            if (!loadedFrom.isValid() || windowStart >= loadedFrom) {
+                int windowCompleted = 0;
+                for (const DateSet &history : histories) {
+                    windowCompleted += refCount(history, windowStart, today);
+                }
+                QCOMPARE(statistics.completionRate(), 100.0 * windowCompleted / (histories.size() * HabitStatistics::kWindowDays));
+            }
+
+            const QVector<float> ratios = statistics.dayRatios(today.year());
+            QCOMPARE(ratios.size(), QDate(today.year(), 1, 1).daysInYear());
+            for (int day = 0; day < ratios.size(); ++day) {
+                const QDate date = QDate(today.year(), 1, 1).addDays(day);
+                int completed = 0;
+                for (const DateSet &history : histories) {
+                    completed += history.contains(date) ? 1 : 0;
+                }
+                QCOMPARE(statistics.completedOn(date), completed);
+                QCOMPARE(ratios.at(day), float(completed) / histories.size());
+            }
+        }
+    }
+}
+
+void HabitHistoryTest::statisticsFollowToggles()
+{
+    const QMap<QString, DateSet> all = scenarios();
+    QList<DateSet> histories = {all.value("dec31_jan1"), all.value("feb29"), all.value("random")};
+    QMap<int, Habit> habits;
+    for (int i = 0; i < histories.size(); ++i) {
+        Habit habit;
+        habit.completedDates = bitmapFrom(histories.at(i));
+        habits.insert(i + 1, habit);
+    }
+
+    HabitStatistics statistics;
+    QDate today(2023, 12, 31);
+    statistics.reset(habits, today);
+
+    // Bascules autour des limites d'année et du 29 février, avec passage à minuit
+    const QList<QDate> toggles = {QDate(2023, 12, 31), QDate(2024, 1, 1), QDate(2023, 12, 30), QDate(2024, 2, 29),
+                                  QDate(2024, 2, 28), QDate(2024, 3, 1), QDate(2024, 1, 1), QDate(2023, 12, 31)};
+    QRandomGenerator rng(31);
+    for (int step = 0; step < 200; ++step) {
+        const int habit = int(rng.bounded(int(histories.size())));
+        const QDate date = step < toggles.size() ? toggles.at(step)
+                                                 : QDate(2023, 12, 1).addDays(rng.bounded(120));
+        const bool completed = !histories.at(habit).contains(date);
+        if (completed) {
+            histories[habit].insert(date);
+        } else {
+            histories[habit].remove(date);
+        }
+        statistics.setCompleted(habit + 1, date, completed);
+
+        if (step == toggles.size()) {
+            today = QDate(2024, 1, 1);
+            statistics.setToday(today);
+        }
+
+        DateSet perfect = histories.first();
+        for (const DateSet &history : histories) {
+            perfect.intersect(history);
+        }
+        QCOMPARE(statistics.perfectDays(), int(perfect.size()));
+        for (int i = 0; i < histories.size(); ++i) {
+            QCOMPARE(statistics.currentStreak(i + 1), refCurrentStreak(histories.at(i), today));
+            QCOMPARE(statistics.longestStreak(i + 1), refLongest(histories.at(i)));
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(HabitHistoryTest)
+#include "habithistorytest.moc"
@@ -0,0 +1,226 @@
+#include "habitstatistics.h"
+
+void HabitStatistics::reset(const QMap<int, Habit> &habits, const QDate &today, int loadedFromYear,
+                            int archivedPerfectDays)
+{
+    m_today = today;
+    m_loadedFrom = loadedFromYear > 0 ? QDate(loadedFromYear, 1, 1) : QDate();
+    m_archivedPerfectDays = archivedPerfectDays;
+    m_habitCount = int(habits.size());
+    m_dayCounts.clear();
+    m_daysByCount.fill(0, m_habitCount + 1);
+    m_windowCompleted = 0;
+    m_streaks.clear();
+    m_runs.clear();
+    m_archives.clear();
+
+    for (auto it = habits.constBegin(); it != habits.constEnd(); ++it) {
+        for (const QDate &date : it->completedDates.dates()) {
+            increment(date);
+        }
+        m_runs.insert(it.key(), CompletionRuns::fromBitmap(it->completedDates));
+        if (!it->archivedYears.isEmpty()) {
+            m_archives.insert(it.key(), archiveFor(it.value(), loadedFromYear));
+        }
+        m_streaks.insert(it.key(), streakFor(it.key()));
+    }
+}
+
+void HabitStatistics::setToday(const QDate &today)
+{
+    if (today == m_today) {
+        return;
+    }
+
+    // Passage à minuit : fenêtre recalculée (kWindowDays recherches) et séries réancrées
+    m_today = today;
+    m_windowCompleted = 0;
+    for (int i = 0; i < kWindowDays; ++i) {
+        m_windowCompleted += m_dayCounts.value(today.addDays(-i));
+    }
+    for (auto it = m_runs.constBegin(); it != m_runs.constEnd(); ++it) {
+        m_streaks.insert(it.key(), streakFor(it.key()));
+    }
+}
+
+void HabitStatistics::addHabit(int habitId)
+{
+    m_habitCount++;
+    m_daysByCount.resize(m_habitCount + 1);
+    m_archivedPerfectDays = 0; // La nouvelle habitude n'a aucun jour archivé
+    m_streaks.insert(habitId, 0);
+    m_runs.insert(habitId, CompletionRuns());
+}
+
+void HabitStatistics::removeHabit(int habitId, const CompletionBitmap &history)
+{
+    if (!m_streaks.contains(habitId)) {
+        return;
+    }
+    for (const QDate &date : history.dates()) {
+        decrement(date);
+    }
+    // Les journées parfaites archivées ne sont pas recalculées : recharger après une suppression
+    m_streaks.remove(habitId);
+    m_runs.remove(habitId);
+    m_archives.remove(habitId);
+    m_habitCount--;
+    m_daysByCount.resize(m_habitCount + 1);
+}
+
+void HabitStatistics::setCompleted(int habitId, const QDate &date, bool completed)
+{
+    CompletionRuns &runs = m_runs[habitId];
+    if (completed) {
+        increment(date);
+        runs.insert(date);
+    } else {
+        decrement(date);
+        runs.remove(date);
+    }
+    m_streaks.insert(habitId, streakFor(habitId));
+}
+
+float HabitStatistics::ratioOn(const QDate &date) const
+{
+    return m_habitCount > 0 ? float(completedOn(date)) / m_habitCount : 0.0f;
+}
+
+QVector<float> HabitStatistics::dayRatios(int year) const
+{
+    const QDate firstDay(year, 1, 1);
+    QVector<float> ratios(firstDay.daysInYear(), 0.0f);
+    if (m_habitCount == 0 || m_dayCounts.isEmpty()) {
+        return ratios;
+    }
+    for (int day = 0; day < ratios.size(); ++day) {
+        ratios[day] = ratioOn(firstDay.addDays(day));
+    }
+    return ratios;
+}
+
+int HabitStatistics::perfectDays() const
+{
+    return m_habitCount > 0 ? m_daysByCount.value(m_habitCount) + m_archivedPerfectDays : 0;
+}
+
+double HabitStatistics::completionRate() const
+{
+    const int possible = m_habitCount * kWindowDays;
+    return possible > 0 ? 100.0 * m_windowCompleted / possible : 0.0;
+}
+
+int HabitStatistics::longestCurrentStreak() const
+{
+    int longest = 0;
+    for (int streak : m_streaks) {
+        longest = qMax(longest, streak);
+    }
+    return longest;
+}
+
+int HabitStatistics::longestStreak(int habitId) const
+{
+    const CompletionRuns runs = m_runs.value(habitId);
+    const auto archive = m_archives.constFind(habitId);
+    if (archive == m_archives.constEnd()) {
+        return runs.longest();
+    }
+    // Une série à cheval sur la limite de chargement compte ses deux parties
+    const int acrossBoundary = archive->chain + runs.runLength(m_loadedFrom);
+    return qMax(qMax(runs.longest(), archive->longest), acrossBoundary);
+}
+
+int HabitStatistics::longestStreakEver() const
+{
+    int longest = 0;
+    for (auto it = m_runs.constBegin(); it != m_runs.constEnd(); ++it) {
+        longest = qMax(longest, longestStreak(it.key()));
+    }
+    return longest;
+}
+
+void HabitStatistics::increment(const QDate &date)
+{
+    int &count = m_dayCounts[date];
+    if (count > 0) {
+        m_daysByCount[count]--;
+    }
+    count++;
+    if (count >= m_daysByCount.size()) {
+        m_daysByCount.resize(count + 1); // Complétion d'une habitude inconnue : reste cohérent
+    }
+    m_daysByCount[count]++;
+
+    if (inWindow(date)) {
+        m_windowCompleted++;
+    }
+}
+
+void HabitStatistics::decrement(const QDate &date)
+{
+    auto it = m_dayCounts.find(date);
+    if (it == m_dayCounts.end()) {
+        return;
+    }
+
+    m_daysByCount[*it]--;
+    if (--*it > 0) {
+        m_daysByCount[*it]++;
+    } else {
+        m_dayCounts.erase(it);
+    }
+
+    if (inWindow(date)) {
+        m_windowCompleted--;
+    }
+}
+
+bool HabitStatistics::inWindow(const QDate &date) const
+{
+    return date <= m_today && date > m_today.addDays(-kWindowDays);
+}
+
+int HabitStatistics::streakFor(int habitId) const
+{
+    const CompletionRuns runs = m_runs.value(habitId);
+
+    // Série qui inclut aujourd'hui s'il est validé, sinon celle qui s'arrête hier
+    QDate end = m_today;
+    int streak = runs.streakAt(end);
+    if (streak == 0) {
+        end = m_today.addDays(-1);
+        streak = runs.streakAt(end);
+    }
+
+    // Série commencée avant la fenêtre chargée : prolongée par la fin des années archivées
+    const int chain = m_archives.value(habitId).chain;
+    if (chain > 0 && end.addDays(1 - streak) == m_loadedFrom) {
+        streak += chain;
+    }
+    return streak;
+}
+
+HabitStatistics::Archive HabitStatistics::archiveFor(const Habit &habit, int loadedFromYear) const
+{
+    // Parcours des années dans l'ordre : une série traverse le 1er janvier quand
+    // l'année précédente se termine validée (trailingRun) et que la suivante
+    // commence validée (leadingRun). Une année sans ligne interrompt la chaîne.
+    Archive archive;
+    int chain = 0;
+    int previousYear = 0;
+    for (auto it = habit.archivedYears.constBegin(); it != habit.archivedYears.constEnd(); ++it) {
+        const int year = it.key();
+        const CompletionBitmap::YearSummary &summary = it.value();
+        if (year != previousYear + 1) {
+            chain = 0;
+        }
+        archive.longest = qMax(archive.longest, qMax(summary.longestRun, chain + summary.leadingRun));
+
+        const int daysInYear = QDate(year, 1, 1).daysInYear();
+        chain = (summary.leadingRun == daysInYear) ? chain + daysInYear : summary.trailingRun;
+        previousYear = year;
+    }
+    archive.chain = (previousYear == loadedFromYear - 1) ? chain : 0;
+    return archive;
+}
@@ -0,0 +1,75 @@
+#ifndef HABITSTATISTICS_H
+#define HABITSTATISTICS_H
+
+#include <QDate>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include "habit.h"
+#include "completionruns.h"
+
+// Statistiques de HabitsView tenues à jour à chaque complétion au lieu d'être
+// recalculées : nombre d'habitudes validées par jour, histogramme de ces nombres
+// (journées parfaites = jours où il vaut le nombre d'habitudes), complétions de
+// la fenêtre glissante, et l'historique de chaque habitude en séries
+// (CompletionRuns) pour la série en cours et les records.
+// Chargement : O(complétions). Ajout / retrait d'une date : O(1) pour les
+// compteurs, O(log n) pour les séries de l'habitude.
+// Seules les années >= loadedFromYear sont détaillées : les années plus anciennes
+// contribuent par leurs résumés (Habit::archivedYears) et le nombre de journées
+// parfaites enregistré en base.
+class HabitStatistics
+{
+public:
+    static constexpr int kWindowDays = 7; // Taux de complétion sur les 7 derniers jours
+
+    void reset(const QMap<int, Habit> &habits, const QDate &today, int loadedFromYear = 0,
+               int archivedPerfectDays = 0);
+    // À appeler à chaque rafraîchissement : ne fait rien tant que la date ne change pas
+    void setToday(const QDate &today);
+
+    void addHabit(int habitId);
+    void removeHabit(int habitId, const CompletionBitmap &history);
+    void setCompleted(int habitId, const QDate &date, bool completed);
+
+    int habitCount() const { return m_habitCount; }
+    int completedOn(const QDate &date) const { return m_dayCounts.value(date); }
+    float ratioOn(const QDate &date) const; // Part des habitudes validées ce jour (0 à 1)
+    QVector<float> dayRatios(int year) const; // ratioOn pour chaque jour de l'année (HabitHeatmap)
+    int perfectDays() const;
+    double completionRate() const; // En pourcentage, sur kWindowDays jours
+    int currentStreak(int habitId) const { return m_streaks.value(habitId); }
+    int longestCurrentStreak() const;
+    int longestStreak(int habitId) const; // Record de l'habitude, années archivées comprises
+    int longestStreakEver() const;        // Record toutes habitudes
+    // Séries des années chargées uniquement
+    int streakOn(int habitId, const QDate &date) const { return m_runs.value(habitId).streakAt(date); }
+    CompletionRuns runs(int habitId) const { return m_runs.value(habitId); }
+
+private:
+    // Résumé des années archivées d'une habitude
+    struct Archive
+    {
+        int longest = 0; // Plus longue série entièrement archivée
+        int chain = 0;   // Série qui se termine le 31 décembre précédant la fenêtre chargée
+    };
+    Archive archiveFor(const Habit &habit, int loadedFromYear) const;
+    int streakFor(int habitId) const;
+
+    void increment(const QDate &date);
+    void decrement(const QDate &date);
+    bool inWindow(const QDate &date) const;
+
+    QDate m_today;
+    QDate m_loadedFrom;             // 1er janvier de la première année chargée (invalide : tout est chargé)
+    int m_archivedPerfectDays = 0;
+    int m_habitCount = 0;
+    QHash<QDate, int> m_dayCounts;  // Habitudes validées par jour (jours à 0 absents)
+    QVector<int> m_daysByCount;     // m_daysByCount[n] = nombre de jours à n habitudes validées
+    int m_windowCompleted = 0;      // Complétions dans ]m_today - kWindowDays, m_today]
+    QMap<int, int> m_streaks;       // Série en cours par habitude
+    QMap<int, CompletionRuns> m_runs;
+    QMap<int, Archive> m_archives;  // Habitudes ayant des années archivées
+};
+
+#endif // HABITSTATISTICS_H
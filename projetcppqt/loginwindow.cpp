@@ -1,5 +1,8 @@
 #include "loginwindow.h"
 #include "dashboardwindow.h"
+#include "asyncdatabasemanager.h"
+#include "connectionpool.h"
+#include "passwordhasher.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -11,8 +14,6 @@
 #include <QPixmap>
 #include <QSpacerItem>
 #include <QStackedWidget>
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QMessageBox>
 #include <QRegularExpression>
 #include <QRegularExpressionValidator>
@@ -22,6 +23,7 @@
 #include <QDateEdit>
 #include <QScrollArea>
 #include <QCryptographicHash>
+#include <QProgressBar>
 
 LoginWindow::LoginWindow(QWidget *parent) : QWidget(parent) {
     setFixedSize(900, 600);
@@ -138,6 +140,7 @@ QWidget* LoginWindow::createLoginPage() {
 
     // Bouton de connexion
     QPushButton *loginButton = new QPushButton("Se connecter");
+    m_loginButton = loginButton;
     loginButton->setStyleSheet(
         "QPushButton {"
         "    background-color: #1a73e8;"
@@ -161,6 +164,15 @@ QWidget* LoginWindow::createLoginPage() {
     loginButtonLayout->addWidget(loginButton);
     loginButtonLayout->addStretch();
 
+    // Indicateur d'activité pendant la vérification du mot de passe
+    m_loginProgress = new QProgressBar;
+    m_loginProgress->setRange(0, 0);
+    m_loginProgress->setTextVisible(false);
+    m_loginProgress->setFixedHeight(4);
+    m_loginProgress->setStyleSheet("QProgressBar { border: none; background-color: #e8f0fe; }"
+                                   "QProgressBar::chunk { background-color: #1a73e8; }");
+    m_loginProgress->setVisible(false);
+
     // Lien vers l'inscription
     QLabel *registerLabel = new QLabel("Pas encore de compte? <a href='#' style='color: #1a73e8; text-decoration: none;'>Créer un compte</a>");
     registerLabel->setTextFormat(Qt::RichText);
@@ -177,6 +189,7 @@ QWidget* LoginWindow::createLoginPage() {
     formLayout->addLayout(optionsLayout);
     formLayout->addSpacing(10);
     formLayout->addLayout(loginButtonLayout);
+    formLayout->addWidget(m_loginProgress);
     formLayout->addWidget(registerLabel);
     formLayout->addStretch();
     loginLayout->addWidget(formContainer);
@@ -392,14 +405,20 @@ QWidget* LoginWindow::createRegisterPage() {
 }
 
 void LoginWindow::setupDatabase() {
-    // Utiliser DatabaseManager au lieu de gérer la connexion directement
-    if (!DatabaseManager::instance().isOpen()) {
-        if (!DatabaseManager::instance().openDatabase()) {
+    // Création et migration du schéma sur le thread base de données : la fenêtre
+    // s'affiche tout de suite, la connexion est possible une fois la base ouverte
+    m_loginButton->setEnabled(false);
+    m_loginProgress->setVisible(true);
+
+    AsyncDatabaseManager::instance().opened().then(this, [this](bool ok) {
+        m_loginProgress->setVisible(false);
+        if (!ok) {
             QMessageBox::critical(this, "Erreur de base de données",
                                   "Impossible d'ouvrir la base de données.");
             return;
         }
-    }
+        m_loginButton->setEnabled(true);
+    });
 }
 
 void LoginWindow::connectSignals() {
@@ -413,80 +432,87 @@ void LoginWindow::connectSignals() {
     // Pour le bouton d'inscription, il est connecté directement dans createRegisterPage()
 }
 
+namespace {
+// Profil et hachage lus sur le thread base de données, puis vérifiés sur le pool de threads
+struct LoginResult
+{
+    bool found = false;
+    bool authenticated = false;
+    QString passwordHash;
+    QString upgradedHash;
+    UserInfo userInfo;
+};
+}
+
 void LoginWindow::onLoginClicked() {
     if (validateLoginForm()) {
         QString email = m_emailLoginEdit->text().trimmed();
         QString password = m_passwordLoginEdit->text();
 
-        DatabaseManager& dbManager = DatabaseManager::instance();
-
-        if (dbManager.checkCredentials(email, password)) {
-            try {
-                // Récupérer l'ID utilisateur
-                int userId = dbManager.getUserId(email);
-
-                // Récupérer les informations de l'utilisateur pour les passer au tableau de bord
-                UserInfo userInfo;
-                userInfo.userId = userId;
-                userInfo.name = dbManager.getUserName(userId);
-                userInfo.planType = dbManager.getUserPlanType(userId);
-
-                // Récupérer les statistiques
-                QSqlQuery statsQuery;
-                statsQuery.prepare("SELECT workout_sessions, calories_burned, activity_minutes, exercises_done "
-                                   "FROM users WHERE id = :id");
-                statsQuery.bindValue(":id", userId);
-
-                if (statsQuery.exec() && statsQuery.next()) {
-                    userInfo.workoutSessions = statsQuery.value("workout_sessions").toInt();
-                    userInfo.caloriesBurned = statsQuery.value("calories_burned").toInt();
-                    userInfo.activityMinutes = statsQuery.value("activity_minutes").toInt();
-                    userInfo.exercisesDone = statsQuery.value("exercises_done").toInt();
-                } else {
-                    // Valeurs par défaut si les données ne sont pas disponibles
-                    userInfo.workoutSessions = 0;
-                    userInfo.caloriesBurned = 0;
-                    userInfo.activityMinutes = 0;
-                    userInfo.exercisesDone = 0;
-                }
+        // Le bouton reste désactivé pendant la vérification ; l'interface continue de se rafraîchir
+        m_loginButton->setEnabled(false);
+        m_loginButton->setText("Connexion...");
+        m_loginProgress->setVisible(true);
+        m_loginErrorLabel->setVisible(false);
 
-                // Récupérer les objectifs
-                QSqlQuery goalsQuery;
-                goalsQuery.prepare("SELECT goal_name, progress FROM user_goals WHERE user_id = :id");
-                goalsQuery.bindValue(":id", userId);
-
-                if (goalsQuery.exec()) {
-                    while (goalsQuery.next()) {
-                        QString goalName = goalsQuery.value("goal_name").toString();
-                        int progress = goalsQuery.value("progress").toInt();
-                        userInfo.goals[goalName] = progress;
-                    }
+        // Lecteur du pool : users et user_goals ne sont écrits pour ce compte qu'après la
+        // connexion, aucune écriture en file ne peut manquer à cette lecture
+        ConnectionPool::instance().read([email](DatabaseManager &dbManager) {
+            // Hachage, profil, statistiques et objectifs en une seule requête
+            LoginResult result;
+            result.found = dbManager.loadSession(email, result.userInfo, result.passwordHash);
+            return result;
+        }).then(QtFuture::Launch::Async, [password](LoginResult result) {
+            // Dérivation de clé coûteuse : hors du thread GUI et du thread base de données
+            if (result.found) {
+                bool needsRehash = false;
+                result.authenticated = PasswordHasher::verify(password, result.passwordHash, &needsRehash);
+                if (result.authenticated && needsRehash) {
+                    result.upgradedHash = PasswordHasher::hash(password);
                 }
+            }
 
-                // Si aucun objectif n'a été trouvé, définir des objectifs par défaut
-                if (userInfo.goals.isEmpty()) {
-                    userInfo.goals["Perte de poids"] = 0;
-                    userInfo.goals["Musculation"] = 0;
-                    userInfo.goals["Cardio"] = 0;
+            // Si aucun objectif n'a été trouvé, définir des objectifs par défaut
+            if (result.authenticated && result.userInfo.goals.isEmpty()) {
+                result.userInfo.goals["Perte de poids"] = 0;
+                result.userInfo.goals["Musculation"] = 0;
+                result.userInfo.goals["Cardio"] = 0;
+            }
+            return result;
+        }).then(this, [this](const LoginResult &result) {
+            m_loginButton->setEnabled(true);
+            m_loginButton->setText("Se connecter");
+            m_loginProgress->setVisible(false);
+
+            if (result.authenticated) {
+                // Migration transparente depuis l'ancien hachage SHA-256 (ou un coût trop faible)
+                if (!result.upgradedHash.isEmpty()) {
+                    const int userId = result.userInfo.userId;
+                    const QString upgradedHash = result.upgradedHash;
+                    AsyncDatabaseManager::instance().run([userId, upgradedHash](DatabaseManager &dbManager) {
+                        return dbManager.updatePasswordHash(userId, upgradedHash);
+                    });
                 }
 
-                // Créer et afficher le tableau de bord avec les informations utilisateur
-                DashboardWindow *dashboard = new DashboardWindow(userInfo);
-                dashboard->show();
-                this->close();
-
-            } catch (const std::exception& e) {
-                qDebug() << "Erreur lors de la récupération des données utilisateur:" << e.what();
+                // Disposition Sharded : l'utilisateur actif est publié à toutes les connexions,
+                // puis la connexion asynchrone attache son fichier avant les premiers chargements
+                // du tableau de bord. Aucune connexion n'est ouverte sur le thread GUI.
+                const int userId = result.userInfo.userId;
+                DatabaseManager::setActiveShardUser(userId);
+                AsyncDatabaseManager::instance().run([userId](DatabaseManager &dbManager) {
+                    dbManager.setCurrentUserId(userId);
+                    return true;
+                });
 
-                // En cas d'erreur, utiliser le constructeur par défaut
-                DashboardWindow *dashboard = new DashboardWindow();
+                // Créer et afficher le tableau de bord avec les informations utilisateur
+                DashboardWindow *dashboard = new DashboardWindow(result.userInfo);
                 dashboard->show();
                 this->close();
+            } else {
+                m_loginErrorLabel->setText("Email ou mot de passe incorrect");
+                m_loginErrorLabel->setVisible(true);
             }
-        } else {
-            m_loginErrorLabel->setText("Email ou mot de passe incorrect");
-            m_loginErrorLabel->setVisible(true);
-        }
+        });
     }
 }
 
@@ -521,11 +547,6 @@ bool LoginWindow::validateLoginForm() {
     return isValid;
 }
 
-bool LoginWindow::checkCredentials(const QString &email, const QString &password) {
-    // Utiliser la méthode de DatabaseManager
-    return DatabaseManager::instance().checkCredentials(email, password);
-}
-
 void LoginWindow::onRegisterLinkClicked() {
     m_stackedWidget->setCurrentIndex(1);
 }
@@ -534,6 +555,16 @@ void LoginWindow::onLoginLinkClicked() {
     m_stackedWidget->setCurrentIndex(0);
 }
 
+namespace {
+// Résultat de l'inscription : requêtes sur le thread base de données, hachage hors de celui-ci
+struct RegistrationResult
+{
+    bool created = false;
+    bool emailTaken = false;
+    QString passwordHash;
+};
+}
+
 void LoginWindow::onSubmitRegistrationClicked() {
     if (validateRegistrationForm()) {
         // Créer l'utilisateur avec gestion d'erreurs détaillée
@@ -553,70 +584,65 @@ void LoginWindow::onSubmitRegistrationClicked() {
             return;
         }
 
-        // Vérifier si l'email existe déjà AVANT d'essayer de créer l'utilisateur
-        DatabaseManager& dbManager = DatabaseManager::instance();
-
-        // Ouvrir la base de données si nécessaire
-        if (!dbManager.isOpen()) {
-            if (!dbManager.openDatabase()) {
-                m_registerErrorLabel->setText("Erreur de connexion à la base de données.");
+        // Vérification de l'e-mail puis création sur le thread base de données ; le hachage
+        // PBKDF2 (~250 ms) est calculé entre les deux pour ne pas retarder les écritures en file
+        m_registerErrorLabel->setVisible(false);
+        setEnabled(false);
+        auto finishRegistration = [this](const RegistrationResult &result) {
+            setEnabled(true);
+
+            if (result.created) {
+                // Effacer les champs après création réussie
+                m_firstNameEdit->clear();
+                m_lastNameEdit->clear();
+                m_emailRegisterEdit->clear();
+                m_passwordRegisterEdit->clear();
+                m_confirmPasswordEdit->clear();
+                m_ageSpinBox->setValue(30);
+                m_weightSpinBox->setValue(70.0);
+                m_heightSpinBox->setValue(170.0);
+                m_fitnessLevelCombo->setCurrentIndex(0);
+
+                // Masquer le message d'erreur
+                m_registerErrorLabel->setVisible(false);
+
+                QMessageBox::information(this, "Inscription réussie",
+                                         "Votre compte a été créé avec succès. Vous pouvez maintenant vous connecter.");
+                m_stackedWidget->setCurrentIndex(0);
+            } else {
+                if (result.emailTaken) {
+                    m_registerErrorLabel->setText("Cette adresse e-mail est déjà utilisée. Veuillez en choisir une autre.");
+                } else {
+                    m_registerErrorLabel->setText("Une erreur est survenue lors de la création du compte. "
+                                                  "Veuillez vérifier vos informations et réessayer.");
+                }
                 m_registerErrorLabel->setVisible(true);
-                return;
             }
-        }
-
-        // Vérifier si l'email existe déjà
-        QSqlQuery checkQuery;
-        checkQuery.prepare("SELECT COUNT(*) FROM users WHERE email = ?");
-        checkQuery.addBindValue(email);
-
-        if (checkQuery.exec() && checkQuery.next()) {
-            if (checkQuery.value(0).toInt() > 0) {
-                m_registerErrorLabel->setText("Cette adresse e-mail est déjà utilisée. Veuillez en choisir une autre.");
-                m_registerErrorLabel->setVisible(true);
-                return;
+        };
+
+        AsyncDatabaseManager::instance().run([email](DatabaseManager &asyncManager) {
+            RegistrationResult result;
+            result.emailTaken = asyncManager.getUserId(email) != -1;
+            return result;
+        }).then(QtFuture::Launch::Async, [password](RegistrationResult result) {
+            if (!result.emailTaken) {
+                result.passwordHash = PasswordHasher::hash(password);
             }
-        } else {
-            m_registerErrorLabel->setText("Erreur lors de la vérification de l'e-mail.");
-            m_registerErrorLabel->setVisible(true);
-            return;
-        }
-
-        // Créer l'utilisateur
-        bool success = dbManager.createUser(firstName, lastName, email, password, age, weight, height, fitnessLevel);
-
-        if (success) {
-            // Effacer les champs après création réussie
-            m_firstNameEdit->clear();
-            m_lastNameEdit->clear();
-            m_emailRegisterEdit->clear();
-            m_passwordRegisterEdit->clear();
-            m_confirmPasswordEdit->clear();
-            m_ageSpinBox->setValue(30);
-            m_weightSpinBox->setValue(70.0);
-            m_heightSpinBox->setValue(170.0);
-            m_fitnessLevelCombo->setCurrentIndex(0);
-
-            // Masquer le message d'erreur
-            m_registerErrorLabel->setVisible(false);
-
-            QMessageBox::information(this, "Inscription réussie",
-                                     "Votre compte a été créé avec succès. Vous pouvez maintenant vous connecter.");
-            m_stackedWidget->setCurrentIndex(0);
-        } else {
-            // Essayer de déterminer la cause de l'erreur
-            QSqlQuery retryCheck;
-            retryCheck.prepare("SELECT COUNT(*) FROM users WHERE email = ?");
-            retryCheck.addBindValue(email);
-
-            if (retryCheck.exec() && retryCheck.next() && retryCheck.value(0).toInt() > 0) {
-                m_registerErrorLabel->setText("Cette adresse e-mail est déjà utilisée.");
-            } else {
-                m_registerErrorLabel->setText("Une erreur est survenue lors de la création du compte. "
-                                              "Veuillez vérifier vos informations et réessayer.");
+            return result;
+        }).then(this, [this, finishRegistration, firstName, lastName, email, age, weight, height, fitnessLevel](const RegistrationResult &checked) {
+            if (checked.emailTaken) {
+                finishRegistration(checked);
+                return;
             }
-            m_registerErrorLabel->setVisible(true);
-        }
+            const QString passwordHash = checked.passwordHash;
+            AsyncDatabaseManager::instance().run([firstName, lastName, email, passwordHash, age, weight, height, fitnessLevel](DatabaseManager &asyncManager) {
+                RegistrationResult result;
+                result.created = asyncManager.createUserWithHash(firstName, lastName, email, passwordHash, age, weight, height, fitnessLevel);
+                // Échec : l'adresse a pu être prise entre-temps
+                result.emailTaken = !result.created && asyncManager.getUserId(email) != -1;
+                return result;
+            }).then(this, finishRegistration);
+        });
     }
 }
 
@@ -700,19 +726,6 @@ bool LoginWindow::validateRegistrationForm() {
 
     return isValid;
 }
-bool LoginWindow::createUser() {
-    // Utiliser la méthode de DatabaseManager
-    return DatabaseManager::instance().createUser(
-        m_firstNameEdit->text().trimmed(),
-        m_lastNameEdit->text().trimmed(),
-        m_emailRegisterEdit->text().trimmed(),
-        m_passwordRegisterEdit->text(),
-        m_ageSpinBox->value(),
-        m_weightSpinBox->value(),
-        m_heightSpinBox->value(),
-        m_fitnessLevelCombo->currentText()
-        );
-}
 
 void LoginWindow::onRegisterClicked() {
     // Cette fonction est déjà prise en charge par onSubmitRegistrationClicked()
@@ -9,6 +9,8 @@
 #include <QSpinBox>
 #include <QDoubleSpinBox>
 #include <QComboBox>
+#include <QPushButton>
+#include <QProgressBar>
 #include <QSqlDatabase>
 #include "databasemanager.h"
 
@@ -39,8 +41,6 @@ private:
 
     bool validateLoginForm();
     bool validateRegistrationForm();
-    bool checkCredentials(const QString &email, const QString &password);
-    bool createUser();
 
     // Database
     QSqlDatabase m_database;
@@ -52,6 +52,8 @@ private:
     QLineEdit *m_emailLoginEdit;
     QLineEdit *m_passwordLoginEdit;
     QLabel *m_loginErrorLabel;
+    QPushButton *m_loginButton;
+    QProgressBar *m_loginProgress;
 
     // Registration form widgets
     QLineEdit *m_firstNameEdit;
@@ -6,6 +6,7 @@
 #include <QPainter>
 #include "loginwindow.h"
 #include "dashboardwindow.h"
+#include "passwordhasher.h"
 
 QPixmap createTransparentIcon(const QString& imagePath, int size = 64) {
     // Charger l'image originale
@@ -34,6 +35,9 @@ QPixmap createTransparentIcon(const QString& imagePath, int size = 64) {
 int main(int argc, char *argv[]) {
     QApplication a(argc, argv);
 
+    // Calibre le coût PBKDF2 en arrière-plan pendant l'affichage de la fenêtre de connexion
+    PasswordHasher::calibrateAsync();
+
     // AJOUT: Définir l'icône de l'application sans fond blanc
     QPixmap iconPixmap = createTransparentIcon(":/images/mon_icone.png");
     a.setWindowIcon(QIcon(iconPixmap));
@@ -0,0 +1,139 @@
+#include "passwordhasher.h"
+#include <QMessageAuthenticationCode>
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QStringList>
+#include <QDebug>
+#include <atomic>
+
+namespace {
+const QString kScheme = "pbkdf2-sha256";
+const int kSaltLength = 16;
+const int kKeyLength = 32;
+const int kMinimumIterations = 10000;
+const int kMaximumIterations = 10000000; // Plafond de calibration ; un hachage stocké au-delà est refusé
+const int kCalibrationIterations = 20000;
+
+// Valeur utilisée tant que la calibration n'est pas terminée
+std::atomic<int> currentIterations(100000);
+}
+
+QByteArray PasswordHasher::pbkdf2Sha256(const QByteArray &password, const QByteArray &salt, int iterations, int keyLength)
+{
+    // RFC 8018 : T_i = U_1 ^ U_2 ^ ... ^ U_c, U_1 = HMAC(P, S || INT(i))
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+    QByteArray key;
+
+    for (quint32 block = 1; key.size() < keyLength; ++block) {
+        QByteArray blockIndex(4, 0);
+        blockIndex[0] = char((block >> 24) & 0xff);
+        blockIndex[1] = char((block >> 16) & 0xff);
+        blockIndex[2] = char((block >> 8) & 0xff);
+        blockIndex[3] = char(block & 0xff);
+
+        mac.reset();
+        mac.addData(salt);
+        mac.addData(blockIndex);
+        QByteArray u = mac.result();
+        QByteArray t = u;
+
+        for (int i = 1; i < iterations; ++i) {
+            mac.reset();
+            mac.addData(u);
+            u = mac.result();
+            for (int j = 0; j < t.size(); ++j) {
+                t[j] = char(t[j] ^ u[j]);
+            }
+        }
+        key.append(t);
+    }
+    return key.left(keyLength);
+}
+
+bool PasswordHasher::constantTimeEquals(const QByteArray &a, const QByteArray &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    unsigned char diff = 0;
+    for (int i = 0; i < a.size(); ++i) {
+        diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
+
+QString PasswordHasher::hash(const QString &password)
+{
+    QByteArray salt(kSaltLength, 0);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(salt.data()), kSaltLength / 4);
+
+    const int cost = iterations();
+    const QByteArray key = pbkdf2Sha256(password.toUtf8(), salt, cost, kKeyLength);
+    return QString("%1$%2$%3$%4").arg(kScheme).arg(cost)
+        .arg(QString::fromLatin1(salt.toBase64()), QString::fromLatin1(key.toBase64()));
+}
+
+bool PasswordHasher::verify(const QString &password, const QString &storedHash, bool *needsRehash)
+{
+    if (needsRehash) {
+        *needsRehash = false;
+    }
+
+    const QStringList parts = storedHash.split('$');
+    if (parts.size() != 4 || parts[0] != kScheme) {
+        // Ancien format : SHA-256 hexadécimal non salé
+        const QByteArray legacy = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex();
+        const bool valid = constantTimeEquals(legacy, storedHash.toLatin1());
+        if (valid && needsRehash) {
+            *needsRehash = true;
+        }
+        return valid;
+    }
+
+    bool ok = false;
+    const int cost = parts[1].toInt(&ok);
+    if (!ok || cost <= 0 || cost > kMaximumIterations) {
+        return false;
+    }
+    const QByteArray salt = QByteArray::fromBase64(parts[2].toLatin1());
+    const QByteArray expected = QByteArray::fromBase64(parts[3].toLatin1());
+    // Clé vide ou tronquée : une comparaison de deux tableaux vides accepterait tout mot de passe
+    if (salt.isEmpty() || expected.size() != kKeyLength) {
+        return false;
+    }
+
+    const bool valid = constantTimeEquals(pbkdf2Sha256(password.toUtf8(), salt, cost, expected.size()), expected);
+    // Marge de moitié : les variations de calibration ne déclenchent pas de re-hachage à chaque connexion
+    if (valid && needsRehash && cost < iterations() / 2) {
+        *needsRehash = true;
+    }
+    return valid;
+}
+
+void PasswordHasher::calibrate(int targetMs)
+{
+    const QByteArray salt(kSaltLength, 'c');
+    QElapsedTimer timer;
+    timer.start();
+    pbkdf2Sha256("calibration", salt, kCalibrationIterations, kKeyLength);
+    const qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    const qint64 scaled = qint64(kCalibrationIterations) * targetMs * 1000000 / elapsedNs;
+    const int cost = int(qBound<qint64>(kMinimumIterations, scaled, kMaximumIterations));
+    currentIterations.store(cost);
+    qDebug() << "PBKDF2 calibré:" << cost << "itérations pour" << targetMs << "ms";
+}
+
+void PasswordHasher::calibrateAsync(int targetMs)
+{
+    QThreadPool::globalInstance()->start([targetMs]() {
+        calibrate(targetMs);
+    });
+}
+
+int PasswordHasher::iterations()
+{
+    return currentIterations.load();
+}
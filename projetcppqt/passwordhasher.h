@@ -0,0 +1,29 @@
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QString>
+#include <QByteArray>
+
+// Hachage des mots de passe par PBKDF2-HMAC-SHA256 salé.
+// Format stocké : "pbkdf2-sha256$<itérations>$<sel base64>$<clé base64>".
+// Les anciens hachages SHA-256 hexadécimaux non salés restent vérifiables
+// et sont signalés comme à migrer (needsRehash). Coûteux par construction :
+// à appeler hors du thread GUI.
+class PasswordHasher
+{
+public:
+    static QString hash(const QString &password);
+    static bool verify(const QString &password, const QString &storedHash, bool *needsRehash = nullptr);
+
+    // Mesure la machine et choisit le nombre d'itérations pour atteindre
+    // targetMs par vérification. calibrateAsync() est lancé au démarrage.
+    static void calibrate(int targetMs = 250);
+    static void calibrateAsync(int targetMs = 250);
+    static int iterations();
+
+private:
+    static QByteArray pbkdf2Sha256(const QByteArray &password, const QByteArray &salt, int iterations, int keyLength);
+    static bool constantTimeEquals(const QByteArray &a, const QByteArray &b);
+};
+
+#endif // PASSWORDHASHER_H
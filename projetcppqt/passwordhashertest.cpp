@@ -0,0 +1,83 @@
+// Vérification des hachages PBKDF2 stockés : une ligne vide, tronquée ou corrompue
+// ne doit jamais authentifier, ni bloquer la connexion par un coût démesuré.
+#include <QtTest>
+#include <QElapsedTimer>
+#include <limits>
+#include "passwordhasher.h"
+
+namespace {
+const QString kSalt = QString::fromLatin1(QByteArray(16, 's').toBase64());
+const QString kKey = QString::fromLatin1(QByteArray(32, 'k').toBase64());
+}
+
+class PasswordHasherTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void rejectsMalformedKey_data();
+    void rejectsMalformedKey();
+    void rejectsExcessiveCost_data();
+    void rejectsExcessiveCost();
+};
+
+void PasswordHasherTest::roundTrip()
+{
+    const QString stored = PasswordHasher::hash("motdepasse");
+    bool needsRehash = true;
+    QVERIFY(PasswordHasher::verify("motdepasse", stored, &needsRehash));
+    QVERIFY(!needsRehash);
+    QVERIFY(!PasswordHasher::verify("autre", stored));
+
+    // Même hachage, clé effacée : refusé quel que soit le mot de passe
+    QStringList parts = stored.split('$');
+    parts[3].clear();
+    QVERIFY(!PasswordHasher::verify("motdepasse", parts.join('$')));
+    QVERIFY(!PasswordHasher::verify("", parts.join('$')));
+}
+
+void PasswordHasherTest::rejectsMalformedKey_data()
+{
+    QTest::addColumn<QString>("storedHash");
+    QTest::newRow("empty_salt_and_key") << QString("pbkdf2-sha256$1000$$");
+    QTest::newRow("empty_key") << QString("pbkdf2-sha256$1000$%1$").arg(kSalt);
+    QTest::newRow("empty_salt") << QString("pbkdf2-sha256$1000$$%1").arg(kKey);
+    QTest::newRow("truncated_key") << QString("pbkdf2-sha256$1000$%1$%2")
+                                          .arg(kSalt, QString::fromLatin1(QByteArray(16, 'k').toBase64()));
+    QTest::newRow("not_base64") << QString("pbkdf2-sha256$1000$%1$***").arg(kSalt);
+}
+
+void PasswordHasherTest::rejectsMalformedKey()
+{
+    QFETCH(QString, storedHash);
+    for (const QString &password : {QString(), QString("motdepasse"), QString("x")}) {
+        bool needsRehash = true;
+        QVERIFY(!PasswordHasher::verify(password, storedHash, &needsRehash));
+        QVERIFY(!needsRehash);
+    }
+}
+
+void PasswordHasherTest::rejectsExcessiveCost_data()
+{
+    QTest::addColumn<QString>("cost");
+    QTest::newRow("above_ceiling") << QString("10000001");
+    QTest::newRow("int_max") << QString::number(std::numeric_limits<int>::max());
+    QTest::newRow("overflow") << QString("99999999999");
+    QTest::newRow("negative") << QString("-1");
+}
+
+void PasswordHasherTest::rejectsExcessiveCost()
+{
+    QFETCH(QString, cost);
+    const QString storedHash = QString("pbkdf2-sha256$%1$%2$%3").arg(cost, kSalt, kKey);
+
+    // Refus avant tout calcul PBKDF2 : la réponse est immédiate
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!PasswordHasher::verify("motdepasse", storedHash));
+    QVERIFY(timer.elapsed() < 100);
+}
+
+QTEST_APPLESS_MAIN(PasswordHasherTest)
+#include "passwordhashertest.moc"
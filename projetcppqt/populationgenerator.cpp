@@ -0,0 +1,399 @@
+// Générateur de population synthétique pour les tests de charge.
+// Remplit fitness_data.db (schéma réel créé par DatabaseManager) avec N
+// utilisateurs : années de complétions d'habitudes, suivi d'hydratation,
+// plans de repas hebdomadaires avec ingrédients et exercices.
+//
+// Usage : azertyfit_popgen --users 10000 [--seed 42] [--years 3]
+//                          [--end-date 2025-01-01] [--output-dir dossier]
+// La sortie est entièrement déterminée par (seed, end-date) : l'utilisateur i
+// reçoit les mêmes données quel que soit N.
+
+#include "databasemanager.h"
+#include "passwordhasher.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDir>
+#include <QDate>
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const int kRowsPerTransaction = 1000000;
+
+// INSERT multi-lignes : une exécution par paquet de lignes plutôt qu'une par
+// ligne, ce qui amortit le coût fixe de QSqlQuery::exec. Le paquet reste sous
+// la limite historique de 999 paramètres de SQLite.
+class BulkInserter
+{
+public:
+    BulkInserter(const QSqlDatabase &database, const QString &table, const QStringList &columns)
+        : m_database(database), m_table(table), m_columns(columns),
+          m_rowsPerStatement(qMax(1, 999 / int(columns.size()))), m_fullQuery(database)
+    {
+        m_fullQuery.prepare(statementFor(m_rowsPerStatement));
+        m_pending.reserve(m_rowsPerStatement * columns.size());
+    }
+
+    bool add(std::initializer_list<QVariant> values)
+    {
+        Q_ASSERT(int(values.size()) == m_columns.size());
+        for (const QVariant &value : values) {
+            m_pending.append(value);
+        }
+        m_rows++;
+        if (m_pending.size() == m_rowsPerStatement * m_columns.size()) {
+            return execute(m_fullQuery);
+        }
+        return true;
+    }
+
+    bool flush()
+    {
+        if (m_pending.isEmpty()) {
+            return true;
+        }
+        QSqlQuery tailQuery(m_database);
+        tailQuery.prepare(statementFor(int(m_pending.size() / m_columns.size())));
+        return execute(tailQuery);
+    }
+
+    qint64 rowCount() const { return m_rows; }
+    const QString &table() const { return m_table; }
+
+private:
+    QString statementFor(int rows) const
+    {
+        const QString tuple = "(" + QStringList(QList<QString>(m_columns.size(), "?")).join(", ") + ")";
+        return QString("INSERT INTO %1 (%2) VALUES %3")
+            .arg(m_table, m_columns.join(", "), QStringList(QList<QString>(rows, tuple)).join(", "));
+    }
+
+    bool execute(QSqlQuery &query)
+    {
+        for (int i = 0; i < m_pending.size(); ++i) {
+            query.bindValue(i, m_pending.at(i));
+        }
+        m_pending.clear();
+        if (!query.exec()) {
+            qWarning() << "Insertion dans" << m_table << "impossible:" << query.lastError().text();
+            return false;
+        }
+        return true;
+    }
+
+    QSqlDatabase m_database;
+    QString m_table;
+    QStringList m_columns;
+    int m_rowsPerStatement;
+    QSqlQuery m_fullQuery;
+    QVariantList m_pending;
+    qint64 m_rows = 0;
+};
+
+double normal(QRandomGenerator &rng, double mean, double stddev)
+{
+    // Box-Muller
+    const double u1 = qMax(1e-12, rng.generateDouble());
+    const double u2 = rng.generateDouble();
+    return mean + stddev * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+// Tirage de k indices distincts parmi n, dans l'ordre croissant
+QVector<int> pickDistinct(QRandomGenerator &rng, int n, int k)
+{
+    QVector<int> indices(n);
+    for (int i = 0; i < n; ++i) {
+        indices[i] = i;
+    }
+    for (int i = 0; i < k; ++i) {
+        std::swap(indices[i], indices[i + int(rng.bounded(n - i))]);
+    }
+    indices.resize(k);
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+const QStringList kFirstNames = {"Yasmine", "Lucas", "Inès", "Hugo", "Sarah", "Adam", "Léa", "Mehdi",
+                                 "Chloé", "Nathan", "Amira", "Louis", "Emma", "Rayan", "Jade", "Tom"};
+const QStringList kLastNames = {"Martin", "Benali", "Dubois", "Haddad", "Moreau", "Laurent", "Mansouri",
+                                "Lefebvre", "Garcia", "Roux", "Fournier", "Cherif", "Girard", "Bonnet"};
+const QStringList kFitnessLevels = {"Débutant", "Intermédiaire", "Avancé"};
+const QStringList kHabitNames = {"Boire 2L d'eau", "Marcher 10 000 pas", "Dormir 8 heures", "Méditer",
+                                 "Étirements", "Pas de sucre", "Lire 20 minutes", "Cardio"};
+const QStringList kMealSlots = {"07:30", "10:00", "12:30", "16:00", "19:30"};
+const QStringList kMealNames = {"Petit-déjeuner", "Collation", "Déjeuner", "Goûter", "Dîner"};
+const int kMealCalories[] = {450, 200, 700, 200, 650};
+const QStringList kIngredients = {"Flocons d'avoine", "Lait", "Banane", "Œufs", "Pain complet", "Poulet",
+                                  "Riz", "Brocoli", "Saumon", "Quinoa", "Yaourt", "Amandes", "Pomme",
+                                  "Lentilles", "Tomates", "Huile d'olive", "Fromage blanc", "Patate douce"};
+const QStringList kExercises = {"Push Ups", "Squats", "Burpees", "Plank", "Lunges", "Jumping Jacks",
+                                "Mountain Climbers", "Crunches", "Running", "Cycling"};
+const QStringList kGoals = {"Perte de poids", "Musculation", "Cardio"};
+
+struct Inserters
+{
+    explicit Inserters(const QSqlDatabase &database)
+        : users(database, "users", {"id", "first_name", "last_name", "email", "password", "age", "weight",
+                                    "height", "fitness_level", "registration_date", "workout_sessions",
+                                    "calories_burned", "activity_minutes", "exercises_done", "plan_type"}),
+          goals(database, "user_goals", {"user_id", "goal_name", "progress"}),
+          habits(database, "habits", {"user_id", "habit_id", "name", "goal_days"}),
+          completions(database, "habit_completion_bitmaps", {"user_id", "habit_id", "year", "bits", "completed_days",
+                                                             "longest_run", "leading_run", "trailing_run"}),
+          yearSummaries(database, "habit_year_summaries", {"user_id", "year", "perfect_days"}),
+          water(database, "water_intake", {"user_id", "date", "daily_goal", "current_amount"}),
+          meals(database, "meals", {"id", "user_id", "day_of_week", "name", "time", "calories", "image_path",
+                                    "protein_g", "carbs_g", "fat_g"}),
+          ingredients(database, "meal_ingredients", {"meal_id", "ingredient_name", "quantity"}),
+          exercises(database, "exercises", {"user_id", "day_of_week", "name", "duration", "calories", "completed"})
+    {}
+
+    QList<BulkInserter*> all()
+    {
+        return {&users, &goals, &habits, &completions, &yearSummaries, &water, &meals, &ingredients, &exercises};
+    }
+    qint64 totalRows() { qint64 total = 0; for (BulkInserter *inserter : all()) total += inserter->rowCount(); return total; }
+
+    BulkInserter users, goals, habits, completions, yearSummaries, water, meals, ingredients, exercises;
+};
+
+// Un utilisateur. L'engagement suit une loi très asymétrique (beaucoup
+// d'utilisateurs occasionnels, quelques assidus) et pilote toutes les fréquences.
+bool generateUser(Inserters &out, quint32 seed, int index, int userId, qint64 &nextMealId, const QDate &endDate,
+                  const QVector<QString> &dates, const QVector<bool> &weekend, const QString &passwordHash)
+{
+    const quint32 seedBuffer[2] = {seed, quint32(index)};
+    QRandomGenerator rng(seedBuffer, 2);
+
+    const double engagement = 0.05 + 0.9 * std::pow(rng.generateDouble(), 2.0);
+    // Ancienneté : les comptes récents sont plus nombreux. dates[0] = date de fin.
+    const int historyDays = qMax(7, int(dates.size() * std::pow(rng.generateDouble(), 1.5)));
+
+    const QString firstName = kFirstNames.at(rng.bounded(int(kFirstNames.size())));
+    const QString lastName = kLastNames.at(rng.bounded(int(kLastNames.size())));
+    const int sessions = int(historyDays * engagement * 0.4);
+    bool ok = out.users.add({userId, firstName, lastName, QString("user%1@popgen.local").arg(userId), passwordHash,
+                             18 + int(rng.bounded(50)), qRound(normal(rng, 72.0, 12.0) * 10) / 10.0,
+                             qRound(normal(rng, 172.0, 9.0) * 10) / 10.0,
+                             kFitnessLevels.at(qMin(2, int(engagement * 3))),
+                             dates.at(historyDays - 1) + " 09:00:00", sessions, sessions * (150 + int(rng.bounded(250))),
+                             sessions * (20 + int(rng.bounded(40))), sessions * (2 + int(rng.bounded(5))),
+                             rng.bounded(10) == 0 ? "Premium" : "Standard"});
+
+    for (const QString &goal : kGoals) {
+        ok = ok && out.goals.add({userId, goal, int(rng.bounded(101) * engagement)});
+    }
+
+    // Habitudes : chaîne de Markov à deux états (la veille réussie rend le jour suivant plus probable)
+    const int habitCount = 1 + int(rng.bounded(1 + int(engagement * 7)));
+    const QVector<int> habitIndices = pickDistinct(rng, int(kHabitNames.size()), habitCount);
+    CompletionBitmap perfectDays; // Intersection des historiques de toutes les habitudes
+    for (int h = 0; ok && h < habitCount; ++h) {
+        const int habitId = h + 1;
+        ok = out.habits.add({userId, habitId, kHabitNames.at(habitIndices.at(h)), 7 * (1 + int(rng.bounded(8)))});
+
+        const double base = engagement * (0.5 + 0.5 * rng.generateDouble());
+        const int startOffset = historyDays - 1 - int(rng.bounded(qMax(1, historyDays / 2)));
+        bool doneYesterday = false;
+        CompletionBitmap completedDates;
+        for (int offset = startOffset; offset >= 0; --offset) {
+            double probability = doneYesterday ? qMin(0.97, base + 0.3) : base * 0.6;
+            if (weekend.at(offset)) {
+                probability *= 0.8;
+            }
+            doneYesterday = rng.generateDouble() < probability;
+            if (doneYesterday) {
+                completedDates.insert(endDate.addDays(-offset));
+            }
+        }
+        // Une ligne par année d'historique avec son résumé, comme DatabaseManager::saveHabit
+        for (int year : completedDates.years()) {
+            const CompletionBitmap::YearSummary summary = completedDates.summary(year);
+            ok = ok && out.completions.add({userId, habitId, year, completedDates.yearBlob(year), summary.completedDays,
+                                            summary.longestRun, summary.leadingRun, summary.trailingRun});
+        }
+        perfectDays = (h == 0) ? completedDates : perfectDays.intersected(completedDates);
+    }
+    for (int year : perfectDays.years()) {
+        ok = ok && out.yearSummaries.add({userId, year, perfectDays.summary(year).completedDays});
+    }
+
+    // Hydratation : jours saisis selon l'engagement, quantité autour de l'objectif
+    const int waterGoal = 1500 + 500 * int(rng.bounded(4));
+    const double waterLogRate = 0.2 + 0.7 * engagement;
+    for (int offset = historyDays - 1; ok && offset >= 0; --offset) {
+        if (rng.generateDouble() < waterLogRate) {
+            const int amount = qBound(0, int(normal(rng, waterGoal * 0.8, waterGoal * 0.25)) / 250 * 250, waterGoal * 2);
+            ok = out.water.add({userId, dates.at(offset), waterGoal, amount});
+        }
+    }
+
+    // Plan de repas hebdomadaire : 3 à 5 repas par jour, 2 à 6 ingrédients chacun
+    for (int day = 0; ok && day < 7; ++day) {
+        const QVector<int> slots = pickDistinct(rng, int(kMealSlots.size()), 3 + int(rng.bounded(3)));
+        for (int slot : slots) {
+            const qint64 mealId = nextMealId++;
+            const int calories = qMax(50, int(normal(rng, kMealCalories[slot], kMealCalories[slot] * 0.2)));
+            // Répartition fixe 20/50/30 % de l'énergie : aucun tirage supplémentaire, les
+            // populations déjà générées avec une graine restent identiques
+            ok = ok && out.meals.add({mealId, userId, day, kMealNames.at(slot), kMealSlots.at(slot), calories, QString(),
+                                      qRound(calories * 0.20 / 4), qRound(calories * 0.50 / 4), qRound(calories * 0.30 / 9)});
+
+            const int ingredientCount = 2 + int(rng.bounded(5));
+            for (int i = 0; ok && i < ingredientCount; ++i) {
+                ok = out.ingredients.add({mealId, kIngredients.at(rng.bounded(int(kIngredients.size()))),
+                                          QString("%1 g").arg(10 * (3 + int(rng.bounded(20))))});
+            }
+        }
+    }
+
+    // Exercices : jours d'entraînement selon l'engagement, noms distincts par jour
+    for (int day = 0; ok && day < 7; ++day) {
+        if (rng.generateDouble() >= engagement) {
+            continue;
+        }
+        const QVector<int> picked = pickDistinct(rng, int(kExercises.size()), 1 + int(rng.bounded(4)));
+        for (int e : picked) {
+            const int minutes = 5 * (1 + int(rng.bounded(9)));
+            ok = ok && out.exercises.add({userId, day, kExercises.at(e), QString("%1 min").arg(minutes),
+                                          minutes * (5 + int(rng.bounded(8))), rng.generateDouble() < 0.7 ? 1 : 0});
+        }
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Les données sont injectées directement dans fitness_data.db
+    qputenv("EFITNESS_STORAGE_LAYOUT", "single");
+    QCoreApplication::setApplicationName("azertyfit_popgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Génère une population synthétique dans fitness_data.db");
+    parser.addHelpOption();
+    QCommandLineOption usersOption("users", "Nombre d'utilisateurs à générer.", "n", "1000");
+    QCommandLineOption seedOption("seed", "Graine du générateur.", "seed", "42");
+    QCommandLineOption yearsOption("years", "Historique maximal par utilisateur, en années.", "n", "3");
+    QCommandLineOption endDateOption("end-date", "Dernier jour de l'historique (AAAA-MM-JJ, aujourd'hui par défaut).", "date");
+    QCommandLineOption outputOption("output-dir", "Dossier de fitness_data.db (dossier courant par défaut).", "dossier", ".");
+    parser.addOptions({usersOption, seedOption, yearsOption, endDateOption, outputOption});
+    parser.process(app);
+
+    const int userCount = parser.value(usersOption).toInt();
+    const quint32 seed = parser.value(seedOption).toUInt();
+    const int years = qBound(1, parser.value(yearsOption).toInt(), 50);
+    const QDate endDate = parser.isSet(endDateOption) ? QDate::fromString(parser.value(endDateOption), Qt::ISODate)
+                                                      : QDate::currentDate();
+    if (userCount < 1 || !endDate.isValid()) {
+        qWarning() << "Paramètres invalides";
+        return 2;
+    }
+
+    // Le schéma (tables, migrations, index, triggers) vient de DatabaseManager
+    QDir().mkpath(parser.value(outputOption));
+    qputenv("EFITNESS_DATA_DIR", QDir(parser.value(outputOption)).absolutePath().toUtf8());
+    QString databasePath;
+    {
+        DatabaseManager schema("efitness_popgen_schema");
+        if (!schema.openDatabase()) {
+            return 1;
+        }
+        databasePath = schema.databasePath();
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    int exitCode = 0;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "efitness_popgen");
+        database.setDatabaseName(databasePath);
+        if (!database.open()) {
+            qWarning() << "Ouverture impossible:" << database.lastError().text();
+            return 1;
+        }
+
+        // Chargement en masse : sans journal ni fsync. Le fichier est à jeter en cas d'interruption.
+        QSqlQuery query(database);
+        query.exec("PRAGMA journal_mode = OFF");
+        query.exec("PRAGMA synchronous = OFF");
+        query.exec("PRAGMA cache_size = -262144");
+        query.exec("PRAGMA temp_store = MEMORY");
+
+        // Ajout à une base existante : identifiants à la suite des lignes présentes
+        int firstUserId = 1;
+        qint64 nextMealId = 1;
+        if (query.exec("SELECT COALESCE(MAX(id), 0) + 1 FROM users") && query.next()) {
+            firstUserId = query.value(0).toInt();
+        }
+        if (query.exec("SELECT COALESCE(MAX(id), 0) + 1 FROM meals") && query.next()) {
+            nextMealId = query.value(0).toLongLong();
+        }
+        query.finish();
+
+        // Dates précalculées : dates[k] = endDate - k jours
+        QVector<QString> dates(years * 365);
+        QVector<bool> weekend(dates.size());
+        for (int k = 0; k < dates.size(); ++k) {
+            const QDate date = endDate.addDays(-k);
+            dates[k] = date.toString("yyyy-MM-dd");
+            weekend[k] = date.dayOfWeek() >= 6;
+        }
+
+        // Un seul hachage pour toute la population (mot de passe "password") :
+        // PBKDF2 par utilisateur rendrait la génération aussi lente que le coût choisi
+        const QString passwordHash = PasswordHasher::hash("password");
+
+        Inserters inserters(database);
+        database.transaction();
+        qint64 committedRows = 0;
+        bool ok = true;
+        for (int i = 0; ok && i < userCount; ++i) {
+            ok = generateUser(inserters, seed, firstUserId + i - 1, firstUserId + i, nextMealId, endDate, dates, weekend, passwordHash);
+
+            const qint64 totalRows = inserters.totalRows();
+            if (totalRows - committedRows >= kRowsPerTransaction) {
+                ok = ok && database.commit() && database.transaction();
+                committedRows = totalRows;
+                fprintf(stderr, "\r%d/%d utilisateurs, %lld lignes", i + 1, userCount, totalRows);
+            }
+        }
+        for (BulkInserter *inserter : inserters.all()) {
+            ok = ok && inserter->flush();
+        }
+        ok = ok && database.commit();
+        fprintf(stderr, "\n");
+
+        if (ok) {
+            // Statistiques du planificateur à jour, puis retour au mode de journal de l'application
+            query.exec("ANALYZE");
+            query.exec("PRAGMA journal_mode = WAL");
+            query.finish();
+
+            const double seconds = elapsed.elapsed() / 1000.0;
+            const qint64 totalRows = inserters.totalRows();
+            for (BulkInserter *inserter : inserters.all()) {
+                fprintf(stderr, "  %-18s %12lld\n", qPrintable(inserter->table()), inserter->rowCount());
+            }
+            fprintf(stderr, "%lld lignes en %.1f s (%.0f lignes/s) -> %s\n", totalRows, seconds,
+                    totalRows / qMax(seconds, 0.001), qPrintable(databasePath));
+        } else {
+            database.rollback();
+            exitCode = 1;
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("efitness_popgen");
+    return exitCode;
+}
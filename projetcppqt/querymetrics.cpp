@@ -0,0 +1,111 @@
+#include "querymetrics.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QMutexLocker>
+#include <QtMath>
+
+double QueryMetrics::OperationStats::percentileMs(double percentile) const
+{
+    if (calls == 0) {
+        return 0.0;
+    }
+
+    const quint64 target = qMax<quint64>(1, quint64(qCeil(calls * percentile)));
+    quint64 cumulative = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        cumulative += histogram[i];
+        if (cumulative >= target) {
+            return qMin(double(quint64(1) << (i + 1)) / 1000.0, maxNs / 1e6);
+        }
+    }
+    return maxNs / 1e6;
+}
+
+QueryMetrics& QueryMetrics::instance()
+{
+    static QueryMetrics instance;
+    return instance;
+}
+
+void QueryMetrics::record(const QString &operation, qint64 elapsedNs, quint64 rows, bool ok)
+{
+    const qint64 micros = qMax<qint64>(1, elapsedNs / 1000);
+    int bucket = 0;
+    while (bucket < kBucketCount - 1 && (qint64(1) << (bucket + 1)) <= micros) {
+        ++bucket;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    OperationStats &stats = m_operations[operation];
+    stats.calls++;
+    if (!ok) {
+        stats.failures++;
+    }
+    stats.rows += rows;
+    stats.totalNs += elapsedNs;
+    stats.maxNs = qMax(stats.maxNs, elapsedNs);
+    stats.histogram[bucket]++;
+}
+
+QMap<QString, QueryMetrics::OperationStats> QueryMetrics::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_operations;
+}
+
+void QueryMetrics::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_operations.clear();
+}
+
+QJsonObject QueryMetrics::toJson() const
+{
+    const QMap<QString, OperationStats> operations = snapshot();
+
+    QJsonObject operationsJson;
+    for (auto it = operations.constBegin(); it != operations.constEnd(); ++it) {
+        const OperationStats &stats = it.value();
+
+        // Seaux non vides uniquement : {"le_us": borne haute, "count": n}
+        QJsonArray histogram;
+        for (int i = 0; i < kBucketCount; ++i) {
+            if (stats.histogram[i] > 0) {
+                QJsonObject bucket;
+                bucket["le_us"] = double(quint64(1) << (i + 1));
+                bucket["count"] = double(stats.histogram[i]);
+                histogram.append(bucket);
+            }
+        }
+
+        QJsonObject operation;
+        operation["calls"] = double(stats.calls);
+        operation["failures"] = double(stats.failures);
+        operation["rows"] = double(stats.rows);
+        operation["total_ms"] = stats.totalNs / 1e6;
+        operation["avg_ms"] = stats.averageMs();
+        operation["p50_ms"] = stats.percentileMs(0.50);
+        operation["p95_ms"] = stats.percentileMs(0.95);
+        operation["max_ms"] = stats.maxNs / 1e6;
+        operation["histogram"] = histogram;
+        operationsJson[it.key()] = operation;
+    }
+
+    QJsonObject root;
+    root["generated_at"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["operations"] = operationsJson;
+    return root;
+}
+
+bool QueryMetrics::dumpToFile(const QString &filePath) const
+{
+    // Écriture atomique : le fichier précédent reste intact en cas d'erreur
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
@@ -0,0 +1,74 @@
+#ifndef QUERYMETRICS_H
+#define QUERYMETRICS_H
+
+#include <QString>
+#include <QMap>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <array>
+
+// Compteurs et histogrammes de latence par opération logique de DatabaseManager
+// (loadMeals, saveHabit...). Partagé par tous les threads qui ouvrent une connexion.
+class QueryMetrics
+{
+public:
+    // Seau i : latence dans [2^i, 2^(i+1)) microsecondes ; le dernier seau est ouvert
+    static constexpr int kBucketCount = 24;
+
+    struct OperationStats
+    {
+        quint64 calls = 0;
+        quint64 failures = 0;
+        quint64 rows = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+        std::array<quint64, kBucketCount> histogram{};
+
+        double averageMs() const { return calls ? totalNs / 1e6 / calls : 0.0; }
+        double percentileMs(double percentile) const; // Borne haute du seau atteint
+    };
+
+    static QueryMetrics& instance();
+
+    void record(const QString &operation, qint64 elapsedNs, quint64 rows, bool ok);
+    QMap<QString, OperationStats> snapshot() const;
+    void reset();
+
+    QJsonObject toJson() const;
+    bool dumpToFile(const QString &filePath) const;
+
+private:
+    QueryMetrics() = default;
+    QueryMetrics(const QueryMetrics&) = delete;
+    QueryMetrics& operator=(const QueryMetrics&) = delete;
+
+    mutable QMutex m_mutex;
+    QMap<QString, OperationStats> m_operations;
+};
+
+// Mesure RAII d'une opération : enregistrée à la sortie de la portée
+class QueryTimer
+{
+public:
+    explicit QueryTimer(const char *operation) : m_operation(operation) { m_timer.start(); }
+    ~QueryTimer()
+    {
+        QueryMetrics::instance().record(QString::fromLatin1(m_operation), m_timer.nsecsElapsed(), m_rows, m_ok);
+    }
+
+    void addRows(qint64 rows) { if (rows > 0) m_rows += quint64(rows); }
+    void fail() { m_ok = false; }
+    bool check(bool ok) { if (!ok) m_ok = false; return ok; }
+
+private:
+    QueryTimer(const QueryTimer&) = delete;
+    QueryTimer& operator=(const QueryTimer&) = delete;
+
+    const char *m_operation;
+    QElapsedTimer m_timer;
+    quint64 m_rows = 0;
+    bool m_ok = true;
+};
+
+#endif // QUERYMETRICS_H
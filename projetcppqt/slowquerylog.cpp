@@ -0,0 +1,130 @@
+#include "slowquerylog.h"
+#include "databasemanager.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSqlError>
+#include <QMap>
+#include <QMutexLocker>
+#include <QDebug>
+
+SlowQueryLog& SlowQueryLog::instance()
+{
+    static SlowQueryLog instance;
+    return instance;
+}
+
+SlowQueryLog::SlowQueryLog()
+    : m_thresholdMs(kDefaultThresholdMs)
+{
+    bool ok = false;
+    const qint64 threshold = qEnvironmentVariable("EFITNESS_SLOW_QUERY_MS").toLongLong(&ok);
+    if (ok) {
+        m_thresholdMs = threshold;
+    }
+
+    m_filePath = DatabaseManager::dataDirectory() + "/slow_queries.log";
+}
+
+void SlowQueryLog::check(const QSqlDatabase &database, const QSqlQuery &query, qint64 elapsedNs)
+{
+    const qint64 threshold = thresholdMs();
+    if (threshold < 0 || elapsedNs < threshold * 1000000) {
+        return;
+    }
+
+    const QString sql = query.lastQuery();
+    const double elapsedMs = elapsedNs / 1e6;
+    qDebug() << "Requête lente (" << elapsedMs << "ms):" << sql.left(80);
+
+    QString entry;
+    entry += QString("=== %1  %2 ms  [%3]\n")
+                 .arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs))
+                 .arg(elapsedMs, 0, 'f', 3)
+                 .arg(database.connectionName());
+    entry += "SQL: " + sql.simplified() + "\n";
+    entry += "Bind: " + redactedBindings(query) + "\n";
+    if (query.lastError().isValid()) {
+        entry += "Error: " + query.lastError().text() + "\n";
+    }
+    entry += "Plan:\n" + queryPlan(database, sql) + "\n";
+    append(entry);
+}
+
+QString SlowQueryLog::redactedBindings(const QSqlQuery &query)
+{
+    // Seuls le type et la taille des textes sont conservés (emails, mots de passe, noms...)
+    QStringList values;
+    const QVariantList bound = query.boundValues();
+    for (const QVariant &value : bound) {
+        if (value.isNull()) {
+            values << "NULL";
+            continue;
+        }
+        switch (value.typeId()) {
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Double:
+        case QMetaType::Bool:
+            values << value.toString();
+            break;
+        case QMetaType::QByteArray:
+            values << QString("<blob %1 octets>").arg(value.toByteArray().size());
+            break;
+        default:
+            values << QString("<texte %1 car.>").arg(value.toString().size());
+            break;
+        }
+    }
+    return values.isEmpty() ? QString("(aucune)") : values.join(", ");
+}
+
+QString SlowQueryLog::queryPlan(const QSqlDatabase &database, const QString &sql)
+{
+    // Les paramètres non liés valent NULL : le plan choisi reste le même
+    QSqlQuery explain(database);
+    if (!explain.exec("EXPLAIN QUERY PLAN " + sql)) {
+        return "  (indisponible: " + explain.lastError().text() + ")";
+    }
+
+    // Colonnes : id, parent, notused, detail. L'indentation suit l'arbre parent -> enfant.
+    QMap<int, int> depthById;
+    QStringList lines;
+    while (explain.next()) {
+        const int id = explain.value(0).toInt();
+        const int parent = explain.value(1).toInt();
+        const int depth = depthById.value(parent, 0) + 1;
+        depthById[id] = depth;
+        lines << QString(depth * 2, ' ') + explain.value(3).toString();
+    }
+    return lines.isEmpty() ? QString("  (vide)") : lines.join("\n");
+}
+
+void SlowQueryLog::append(const QString &entry)
+{
+    QMutexLocker locker(&m_fileMutex);
+
+    if (QFileInfo(m_filePath).size() >= kMaxFileBytes) {
+        rotate();
+    }
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "Impossible d'ouvrir le journal des requêtes lentes:" << m_filePath;
+        return;
+    }
+    file.write(entry.toUtf8());
+    file.write("\n");
+}
+
+void SlowQueryLog::rotate()
+{
+    // slow_queries.log.N-1 -> .N, ..., slow_queries.log -> .1 ; le plus ancien est supprimé
+    QFile::remove(QString("%1.%2").arg(m_filePath).arg(kRotatedFiles));
+    for (int i = kRotatedFiles - 1; i >= 1; --i) {
+        QFile::rename(QString("%1.%2").arg(m_filePath).arg(i), QString("%1.%2").arg(m_filePath).arg(i + 1));
+    }
+    QFile::rename(m_filePath, m_filePath + ".1");
+}
@@ -0,0 +1,46 @@
+#ifndef SLOWQUERYLOG_H
+#define SLOWQUERYLOG_H
+
+#include <QString>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <atomic>
+
+// Journal des requêtes lentes : au-delà du seuil, le SQL, les valeurs liées
+// (masquées), la durée et le plan EXPLAIN QUERY PLAN sont ajoutés à
+// slow_queries.log (dossier DatabaseManager::dataDirectory()), avec rotation par taille.
+// Le seuil (en ms) est lu dans EFITNESS_SLOW_QUERY_MS ; une valeur négative désactive le journal.
+class SlowQueryLog
+{
+public:
+    static constexpr qint64 kDefaultThresholdMs = 100;
+    static constexpr qint64 kMaxFileBytes = 1024 * 1024;
+    static constexpr int kRotatedFiles = 3; // slow_queries.log.1 ... .3
+
+    static SlowQueryLog& instance();
+
+    qint64 thresholdMs() const { return m_thresholdMs.load(std::memory_order_relaxed); }
+    void setThresholdMs(qint64 thresholdMs) { m_thresholdMs.store(thresholdMs, std::memory_order_relaxed); }
+    QString filePath() const { return m_filePath; }
+
+    // Appelé après chaque exécution, sur le thread propriétaire de la connexion
+    // (nécessaire pour l'EXPLAIN). Ne coûte qu'une comparaison sous le seuil.
+    void check(const QSqlDatabase &database, const QSqlQuery &query, qint64 elapsedNs);
+
+private:
+    SlowQueryLog();
+    SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+    static QString redactedBindings(const QSqlQuery &query);
+    static QString queryPlan(const QSqlDatabase &database, const QString &sql);
+    void append(const QString &entry);
+    void rotate();
+
+    std::atomic<qint64> m_thresholdMs;
+    QString m_filePath;
+    QMutex m_fileMutex;
+};
+
+#endif // SLOWQUERYLOG_H
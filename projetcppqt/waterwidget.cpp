@@ -1,4 +1,5 @@
 #include "waterwidget.h"
+#include "asyncdatabasemanager.h"
 #include <QDate>
 #include <QMessageBox>
 #include <QFontDatabase>
@@ -29,12 +30,22 @@ WaterGlassButton::WaterGlassButton(const QString &text, int amount, QWidget *par
 }
 // ===== WaterWidget Implementation =====
 WaterWidget::WaterWidget(int userId, QWidget *parent)
-    : QFrame(parent), m_userId(userId), m_dailyGoal(2000), m_currentAmount(0)
+    : QFrame(parent), m_userId(userId), m_dailyGoal(2000), m_currentAmount(0), m_loaded(false),
+      m_dirty(false), m_saveDebounceTimer(nullptr)
 {
     setupUI();
     styleComponents();
-    loadData();
     updateUI();
+    loadData();
+
+    // Dernière écriture avant l'arrêt du thread base de données
+    connect(&AsyncDatabaseManager::instance(), &AsyncDatabaseManager::aboutToShutdown,
+            this, &WaterWidget::flushData);
+}
+
+WaterWidget::~WaterWidget()
+{
+    flushData();
 }
 
 void WaterWidget::setupUI()
@@ -207,10 +218,16 @@ void WaterWidget::setupUI()
     connect(m_customSpinBox, &QSpinBox::valueChanged, m_customSlider, &QSlider::setValue);
     connect(m_addCustomButton, &QPushButton::clicked, this, &WaterWidget::onAddButtonClicked);
 
-    // Timer pour sauvegarder automatiquement les données
+    // Plusieurs clics rapprochés ne donnent qu'une seule écriture
+    m_saveDebounceTimer = new QTimer(this);
+    m_saveDebounceTimer->setSingleShot(true);
+    m_saveDebounceTimer->setInterval(1000);
+    connect(m_saveDebounceTimer, &QTimer::timeout, this, &WaterWidget::flushData);
+
+    // Point de contrôle : écrit toutes les minutes uniquement s'il reste des modifications
     QTimer *saveTimer = new QTimer(this);
-    connect(saveTimer, &QTimer::timeout, this, [=]() { saveData(); });
-    saveTimer->start(60000); // Sauvegarde toutes les minutes
+    connect(saveTimer, &QTimer::timeout, this, &WaterWidget::flushData);
+    saveTimer->start(60000);
 }
 
 QFrame* WaterWidget::createSeparator()
@@ -500,15 +517,52 @@ void WaterWidget::onGlassButtonClicked()
 
 void WaterWidget::saveData()
 {
-    DatabaseManager::instance().saveWaterData(m_userId, QDate::currentDate().toString(Qt::ISODate), m_dailyGoal, m_currentAmount);
+    // Rien à écrire tant que les valeurs du jour n'ont pas été lues
+    if (!m_loaded) {
+        return;
+    }
+
+    m_dirty = true;
+    m_saveDebounceTimer->start(); // Relance le délai à chaque modification
+}
+
+void WaterWidget::flushData()
+{
+    m_saveDebounceTimer->stop();
+    if (!m_dirty) {
+        return;
+    }
+    m_dirty = false;
+
+    // Écriture en file sur le thread base de données : aucun blocage de l'interface
+    AsyncDatabaseManager::instance()
+        .saveWaterData(m_userId, QDate::currentDate().toString(Qt::ISODate), m_dailyGoal, m_currentAmount)
+        .then(this, [this](bool saved) {
+            if (!saved) {
+                m_dirty = true; // Nouvelle tentative au prochain point de contrôle
+            }
+        });
 }
 
 // DANS la fonction WaterWidget::loadData()
 void WaterWidget::loadData()
 {
-    if (!DatabaseManager::instance().loadWaterData(m_userId, QDate::currentDate().toString(Qt::ISODate), m_dailyGoal, m_currentAmount)) {
-        m_dailyGoal = 2000;
-        m_currentAmount = 0;
-    }
-    m_progressBar->setMaximum(m_dailyGoal);
+    // Affichage provisoire, désactivé tant que les données n'ont pas été lues
+    setEnabled(false);
+    m_amountLabel->setText("Chargement...");
+
+    AsyncDatabaseManager::instance().loadWaterData(m_userId, QDate::currentDate().toString(Qt::ISODate))
+        .then(this, [this](const DbResult<AsyncDatabaseManager::WaterData> &result) {
+            if (result.ok) {
+                m_dailyGoal = result.value.dailyGoal;
+                m_currentAmount = result.value.currentAmount;
+            } else {
+                m_dailyGoal = 2000;
+                m_currentAmount = 0;
+            }
+            m_loaded = true;
+            m_progressBar->setMaximum(m_dailyGoal);
+            updateUI();
+            setEnabled(true);
+        });
 }
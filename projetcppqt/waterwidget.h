@@ -36,9 +36,11 @@ class WaterWidget : public QFrame
 
 public:
      explicit WaterWidget(int userId, QWidget *parent = nullptr);
+    ~WaterWidget();
     void setDailyGoal(int milliliters);
     int consumedWater() const;
-    void saveData();
+    void saveData();  // Marque l'état comme modifié ; l'écriture est regroupée (write-behind)
+    void flushData(); // Écrit immédiatement si l'état a changé depuis la dernière écriture
     void loadData();
 
 public slots:
@@ -55,6 +57,9 @@ private:
       int m_userId;
     int m_dailyGoal;
     int m_currentAmount;
+    bool m_loaded; // Données du jour reçues du thread base de données
+    bool m_dirty;  // Modifications pas encore transmises à la base
+    QTimer *m_saveDebounceTimer;
 
     // UI Components
     QLabel *m_titleLabel;